@@ -188,6 +188,7 @@ if np > 0:
       cpu.dtb.size = 16
 
 if options.accel_cfg_file:
+  system.accel_manager.huge_page_size = options.accel_huge_page_size
   config = ConfigParser.SafeConfigParser()
   config.read(options.accel_cfg_file)
   accels = config.sections()
@@ -159,6 +159,9 @@ def addCommonOptions(parser):
     # Aladdin Options
     parser.add_option("--accel_cfg_file", default=None,
                       help="Aladdin accelerator configuration file.")
+    parser.add_option("--accel_huge_page_size", default="0B",
+                      help="Back arrays mapped for accelerators with pages "
+                      "of this size (e.g. 2MB or 1GB); 0B keeps base pages.")
     # Enable Ruby
     parser.add_option("--ruby", action="store_true")
 
@@ -217,6 +220,22 @@ def addCommonOptions(parser):
         help="restore from checkpoint <N>")
     parser.add_option("--checkpoint-at-end", action="store_true",
                       help="take a checkpoint at end of run")
+    parser.add_option("--checkpoint-incremental", action="store_true",
+                      help="only store the memory written since the "
+                           "previous checkpoint taken or restored")
+    parser.add_option("--checkpoint-uncompressed", action="store_true",
+                      help="store memory images uncompressed, so that "
+                           "restoring maps them instead of reading them")
+    parser.add_option("--fan-out", action="store", type="string",
+                      metavar="FILE",
+                      help="checkpoint the region of interest, marked by the "
+                           "workload requesting a checkpoint, and simulate "
+                           "each design point in FILE from there in a child "
+                           "process with its own output directory")
+    parser.add_option("--fan-out-jobs", action="store", type="int",
+                      default=0,
+                      help="number of design points to simulate at once "
+                           "with --fan-out [Default: number of host CPUs]")
     parser.add_option("--work-begin-checkpoint-count", action="store", type="int",
                       help="checkpoint at specified work begin count")
     parser.add_option("--work-end-checkpoint-count", action="store", type="int",
@@ -267,6 +286,26 @@ def addCommonOptions(parser):
     # Stats options.
     parser.add_option("--enable-stats-dump", action="store_true", default=False,
         help="Dump stats if sim loop exits with cause \"dump statistics\".")
+    parser.add_option("--stats-dump-changed-only", action="store_true",
+        default=False,
+        help="Only emit the stats that changed since the previous dump "
+             "in dumps requested by the workload.")
+    parser.add_option("--stats-dump-include", action="append", default=[],
+        metavar="GLOB",
+        help="Only emit stats whose names match GLOB in dumps requested "
+             "by the workload. May be given more than once.")
+    parser.add_option("--calendar-event-queue", action="store_true",
+        help="Order pending events with a calendar queue instead of a "
+             "sorted list. Faster when many events are pending.")
+    parser.add_option("--adaptive-quantum", action="store_true",
+        help="Synchronize parallel event queues adaptively, using the "
+             "latency of the links between them as quantum.")
+    parser.add_option("--event-profile", action="store_true",
+        help="Profile the host time spent on each type of event and write "
+             "it to event_profile.txt on exit.")
+    parser.add_option("--event-profile-by-name", action="store_true",
+        help="With --event-profile, profile each event by name, which "
+             "tells SimObjects apart but is slower.")
 
 def addSEOptions(parser):
     # Benchmark options
@@ -39,6 +39,7 @@
 #
 # Authors: Lisa Hsu
 
+import os
 import sys
 from os import getcwd
 from os.path import join as joinpath
@@ -263,8 +264,14 @@ def dumpStatsInterval(options, maxtick):
 
     while exit_dump_stats or exit_reset_stats:
         if exit_dump_stats:
-          stats_desc = exit_cause[len("statistics_dump:"):]
-          m5.stats.dump(stats_desc)
+          # The workload may append filter options to the description.
+          stats_desc, changed_only, include = m5.stats.parseDumpDesc(
+              exit_cause[len("statistics_dump:"):])
+          if changed_only is None:
+              changed_only = options.stats_dump_changed_only
+          if include is None:
+              include = options.stats_dump_include
+          m5.stats.dump(stats_desc, changed_only, include)
         m5.stats.reset()
         exit_event = m5.simulate(maxtick - m5.curTick())
         exit_cause = exit_event.getCause()
@@ -292,6 +299,114 @@ def benchCheckpoints(options, maxtick, cptdir):
 
     return exit_event
 
+# Options of the simulation fanning out that the design points must
+# not inherit, and whether they take a value
+fan_out_only_options = {
+    "--fan-out" : True, "--fan-out-jobs" : True,
+    "-F" : True, "--fast-forward" : True,
+    "-r" : True, "--checkpoint-restore" : True, "--checkpoint-dir" : True,
+    "--take-checkpoints" : True, "--checkpoint-at-end" : False,
+}
+
+def stripOptions(args, strip):
+    """Remove the options in strip, which maps each option to whether
+    it takes a value, from the command line args."""
+    stripped = []
+    skip_value = False
+    for arg in args:
+        if skip_value:
+            skip_value = False
+            continue
+        name = arg.split("=", 1)[0]
+        if name in strip:
+            skip_value = strip[name] and "=" not in arg
+        elif not (arg[:2] in strip and not arg.startswith("--")):
+            stripped.append(arg)
+    return stripped
+
+def fanOut(options, maxtick):
+    """Simulate up to the region of interest, marked by the workload
+    requesting a checkpoint, and checkpoint it. Then simulate each design
+    point in the --fan-out file from that checkpoint, in a child process
+    with an output directory of its own named after the design point.
+
+    The design point file has one section per design point, holding the
+    command line options to override, e.g.:
+
+        [l2_1MB]
+        l2_size = 1MB
+
+    Options without a value are passed as flags. The memory image is
+    stored uncompressed, so the children map it rather than read it, and
+    share the pages they do not write."""
+    from ConfigParser import ConfigParser
+    import multiprocessing
+
+    design_points = ConfigParser()
+    design_points.optionxform = str
+    if not design_points.read(options.fan_out):
+        fatal("Can't read design points from %s", options.fan_out)
+
+    exit_event = m5.simulate(maxtick - m5.curTick())
+    if exit_event.getCause() != "checkpoint":
+        warn("Exited before reaching the region of interest, not fanning out")
+        return exit_event
+
+    fan_out_dir = joinpath(m5.options.outdir, "fan-out")
+    m5.checkpoint(joinpath(fan_out_dir, "cpt.%d"))
+
+    # the children run the same gem5 command line, where sys.argv holds
+    # the script and its arguments, and whatever precedes it the gem5
+    # binary and its own options
+    cmdline = open("/proc/self/cmdline").read().split("\0")[:-1]
+    if cmdline[len(cmdline) - len(sys.argv):] != sys.argv:
+        fatal("Can't find the script arguments on the gem5 command line")
+    gem5_args = cmdline[:len(cmdline) - len(sys.argv)]
+    script_args = stripOptions(sys.argv[1:], fan_out_only_options)
+    gem5_binary = os.readlink("/proc/self/exe")
+
+    jobs = options.fan_out_jobs or multiprocessing.cpu_count()
+    running = {}
+    failed = []
+
+    def reap():
+        pid, status = os.wait()
+        if status != 0:
+            failed.append(running[pid])
+        print "Design point %s finished with status %d" % \
+            (running[pid], status)
+        del running[pid]
+
+    for point in design_points.sections():
+        while len(running) >= jobs:
+            reap()
+
+        args = gem5_args + ["--outdir=%s" % joinpath(m5.options.outdir, point),
+                            "--redirect-stdout", "--redirect-stderr"]
+        args += sys.argv[:1] + script_args
+        args += ["--checkpoint-dir=%s" % fan_out_dir, "--checkpoint-restore=1"]
+        for name, value in design_points.items(point):
+            args.append("--%s=%s" % (name, value) if value else "--" + name)
+
+        print "Simulating design point %s" % point
+        sys.stdout.flush()
+        sys.stderr.flush()
+        pid = os.fork()
+        if pid == 0:
+            try:
+                os.execv(gem5_binary, args)
+            finally:
+                os._exit(1)
+        running[pid] = point
+
+    while running:
+        reap()
+
+    if failed:
+        fatal("Design points %s failed", ", ".join(failed))
+
+    return exit_event
+
 # Set up environment for taking SimPoint checkpoints
 # Expecting SimPoint files generated by SimPoint 3.2
 def parseSimpointAnalysisFile(options, testsys):
@@ -457,6 +572,25 @@ def run(options, root, testsys, cpu_class):
     if options.repeat_switch and options.take_checkpoints:
         fatal("Can't specify both --repeat-switch and --take-checkpoints")
 
+    if options.calendar_event_queue:
+        root.calendar_event_queue = True
+    if options.adaptive_quantum:
+        root.sim_quantum_adaptive = True
+    if options.event_profile:
+        root.event_profile = True
+        root.event_profile_by_name = bool(options.event_profile_by_name)
+    if options.checkpoint_incremental:
+        testsys.incremental_checkpoints = True
+    if options.checkpoint_uncompressed:
+        testsys.uncompressed_checkpoints = True
+
+    if options.fan_out:
+        if options.checkpoint_restore != None or options.take_checkpoints or \
+                options.repeat_switch:
+            fatal("Can't combine --fan-out with --checkpoint-restore, " \
+                  "--take-checkpoints or --repeat-switch")
+        testsys.uncompressed_checkpoints = True
+
     np = options.num_cpus
     switch_cpus = None
 
@@ -704,7 +838,9 @@ def run(options, root, testsys, cpu_class):
 
         # If checkpoints are being taken, then the checkpoint instruction
         # will occur in the benchmark code it self.
-        if options.repeat_switch and maxtick > options.repeat_switch:
+        if options.fan_out:
+            exit_event = fanOut(options, maxtick)
+        elif options.repeat_switch and maxtick > options.repeat_switch:
             exit_event = repeatSwitch(testsys, repeat_switch_cpu_list,
                                       maxtick, options.repeat_switch)
         elif options.enable_stats_dump:
@@ -73,6 +73,11 @@ def define_options(parser):
                       choices=['fixed', 'flexible'], help="'fixed'|'flexible'")
     parser.add_option("--network-fault-model", action="store_true", default=False,
                       help="enable network fault model: see src/mem/ruby/network/fault_model/")
+    parser.add_option("--ruby-event-queues", type="int", default=1,
+                      help="spread the routers and the controllers attached "
+                           "to them over this many event queues, simulated "
+                           "in parallel (simple network only, implies "
+                           "--adaptive-quantum)")
 
     # ruby mapping options
     parser.add_option("--numa-high-bit", type="int", default=0,
@@ -144,6 +149,41 @@ def setup_memory_controllers(system, ruby, dir_cntrls, dma_cntrls, options):
         ruby.crossbars = crossbars
 
 
+def partition_event_queues(options, system, network, cpu_sequencers,
+                           dir_cntrls, dma_cntrls):
+    """ Assign the routers to event queues in contiguous blocks of router
+        ids, and every controller to the queue of the router it attaches
+        to, since controllers pass messages to their router without a
+        link latency. Routers serving directory or DMA controllers stay on
+        queue 0, with the memory crossbar those use. Each CPU follows its
+        sequencer. Only the links between routers then cross queues, and
+        their latency bounds the simulation quantum.
+    """
+    num_queues = options.ruby_event_queues
+    pinned = [id(c) for c in dir_cntrls + dma_cntrls]
+    pinned_routers = [id(link.int_node) for link in network.ext_links
+                      if id(link.ext_node) in pinned]
+
+    queue_of = {}
+    for (i, router) in enumerate(network.routers):
+        if id(router) in pinned_routers:
+            queue = 0
+        else:
+            queue = i * num_queues // len(network.routers)
+        router.eventq_index = queue
+        queue_of[id(router)] = queue
+
+    for link in network.ext_links:
+        queue = queue_of[id(link.int_node)]
+        link.ext_node.eventq_index = queue
+        seq = getattr(link.ext_node, "sequencer", None)
+        if seq != None:
+            queue_of[id(seq)] = queue
+
+    if len(getattr(system, "cpu", [])) == len(cpu_sequencers):
+        for (cpu, seq) in zip(system.cpu, cpu_sequencers):
+            cpu.eventq_index = queue_of.get(id(seq), 0)
+
 def create_topology(controllers, options):
     """ Called from create_system in configs/ruby/<protocol>.py
         Must return an object which is a subclass of BaseTopology
@@ -224,6 +264,17 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
 
     setup_memory_controllers(system, ruby, dir_cntrls, dma_cntrls, options)
 
+    if options.ruby_event_queues > 1:
+        if options.garnet_network:
+            fatal("--ruby-event-queues needs the simple network")
+        if piobus != None:
+            fatal("--ruby-event-queues can't be used with a PIO bus")
+        partition_event_queues(options, system, network, cpu_sequencers,
+                               dir_cntrls, dma_cntrls)
+        # The queues are synchronized using the lookahead of the links
+        # between routers, no quantum has to be given.
+        options.adaptive_quantum = True
+
     # Connect the cpu sequencers and the piobus
     if piobus != None:
         for cpu_seq in cpu_sequencers:
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __BASE_FREE_LIST_HH__
+#define __BASE_FREE_LIST_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @file base/free_list.hh
+ *
+ * A free list that recycles the storage of objects of a single type.
+ */
+
+/**
+ * Keeps the storage of released objects around so that the next
+ * allocation does not go to the heap. Every block is obtained with
+ * ::operator new(sizeof(T)), so an object handed out by the free list
+ * may still be destroyed with a plain delete by whoever ends up owning
+ * it, and an object created with new may be released to the list.
+ * Only objects whose dynamic type is T may be released.
+ */
+template <class T>
+class FreeList
+{
+  private:
+    /** Storage of released objects, ready for reuse. */
+    std::vector<void *> blocks;
+
+    /** Most blocks kept, any excess is returned to the heap. */
+    size_t maxBlocks;
+
+    /** Number of blocks taken from the heap. */
+    uint64_t _heapAllocations;
+
+  public:
+    explicit FreeList(size_t max_blocks = 1024)
+        : maxBlocks(max_blocks), _heapAllocations(0)
+    {}
+
+    ~FreeList()
+    {
+        for (auto block : blocks)
+            ::operator delete(block);
+    }
+
+    FreeList(const FreeList &) = delete;
+    FreeList &operator=(const FreeList &) = delete;
+
+    /** Construct an object, reusing released storage if there is any. */
+    template <typename... Args>
+    T *
+    allocate(Args&&... args)
+    {
+        void *block;
+        if (blocks.empty()) {
+            block = ::operator new(sizeof(T));
+            _heapAllocations++;
+        } else {
+            block = blocks.back();
+            blocks.pop_back();
+        }
+        return new (block) T(std::forward<Args>(args)...);
+    }
+
+    /** Destroy an object and keep its storage for the next allocation. */
+    void
+    release(T *obj)
+    {
+        obj->~T();
+        if (blocks.size() < maxBlocks)
+            blocks.push_back(obj);
+        else
+            ::operator delete(obj);
+    }
+
+    /** Number of blocks ready for reuse. */
+    size_t size() const { return blocks.size(); }
+
+    /** Number of blocks that were taken from the heap. */
+    uint64_t heapAllocations() const { return _heapAllocations; }
+};
+
+#endif // __BASE_FREE_LIST_HH__
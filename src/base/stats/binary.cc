@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "base/stats/binary.hh"
+#include "base/stats/flatten.hh"
+#include "base/stats/info.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "sim/byteswap.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+namespace Stats {
+
+Binary::Binary()
+    : mystream(false), stream(NULL)
+{
+}
+
+Binary::Binary(const std::string &file)
+    : mystream(false), stream(NULL)
+{
+    open(file);
+}
+
+Binary::~Binary()
+{
+    if (mystream) {
+        assert(stream);
+        delete stream;
+    }
+}
+
+void
+Binary::open(std::ostream &_stream)
+{
+    if (stream)
+        panic("stream already set!");
+
+    mystream = false;
+    stream = &_stream;
+    if (!valid())
+        fatal("Unable to open output stream for writing\n");
+
+    writeHeader();
+}
+
+void
+Binary::open(const std::string &file)
+{
+    if (stream)
+        panic("stream already set!");
+
+    mystream = true;
+    stream = new ofstream(file.c_str(), ios::trunc | ios::binary);
+    if (!valid())
+        fatal("Unable to open statistics file for writing\n");
+
+    writeHeader();
+}
+
+bool
+Binary::valid() const
+{
+    return stream != NULL && stream->good();
+}
+
+void
+Binary::begin(std::string desc)
+{
+    dumpDesc = desc;
+    values.clear();
+    groups.clear();
+}
+
+void
+Binary::end()
+{
+    for (off_type i = 0; i < groups.size(); ++i) {
+        const Group &group = groups[i];
+        if (group.info->id >= schema.size())
+            schema.resize(group.info->id + 1);
+        if (schema[group.info->id] != group)
+            writeSchema(group);
+    }
+
+    writeU8('D');
+    writeU64(curTick());
+    writeString(dumpDesc);
+    writeU32(groups.size());
+
+    // Encode the (stat id, values) pairs into one buffer so the whole
+    // record goes out with a single write.
+    record.clear();
+    off_type col = 0;
+    for (off_type i = 0; i < groups.size(); ++i) {
+        uint32_t id = htole((uint32_t)groups[i].info->id);
+        append(&id, sizeof(id));
+        for (off_type j = 0; j < groups[i].count; ++j, ++col) {
+            uint64_t bits;
+            memcpy(&bits, &values[col], sizeof(bits));
+            bits = htole(bits);
+            append(&bits, sizeof(bits));
+        }
+    }
+    assert(col == values.size());
+
+    stream->write(record.data(), record.size());
+    stream->flush();
+}
+
+void
+Binary::add(const Info &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    Group group;
+    group.info = &info;
+    group.count = values.size();
+    group.names = 0;
+
+    // Rebucketing a histogram or adding a key to a sparse histogram can
+    // rename its columns without changing how many there are, so the
+    // names of distributions are part of the layout.
+    if (dynamic_cast<const DistInfo *>(&info) ||
+        dynamic_cast<const VectorDistInfo *>(&info) ||
+        dynamic_cast<const SparseHistInfo *>(&info)) {
+        distNames.clear();
+        distDescs.clear();
+        flatten(info, values, &distNames, &distDescs);
+        hash<string> hasher;
+        for (off_type i = 0; i < distNames.size(); ++i) {
+            group.names ^= hasher(distNames[i]) + 0x9e3779b9 +
+                (group.names << 6) + (group.names >> 2);
+        }
+    } else {
+        flatten(info, values);
+    }
+
+    group.count = values.size() - group.count;
+    groups.push_back(group);
+}
+
+void
+Binary::writeHeader()
+{
+    stream->write("gem5stat", 8);
+    writeU32(Version);
+}
+
+void
+Binary::writeSchema(const Group &group)
+{
+    VResult scratch;
+    vector<string> names;
+    vector<string> descs;
+    flatten(*group.info, scratch, &names, &descs);
+    assert(names.size() == group.count);
+
+    writeU8('S');
+    writeU32(group.info->id);
+    writeU32(names.size());
+    for (off_type i = 0; i < names.size(); ++i) {
+        writeString(names[i]);
+        writeString(descs[i]);
+    }
+
+    schema[group.info->id] = group;
+}
+
+void
+Binary::append(const void *data, size_t len)
+{
+    const char *bytes = (const char *)data;
+    record.insert(record.end(), bytes, bytes + len);
+}
+
+void
+Binary::writeString(const std::string &str)
+{
+    uint16_t len = ::min<size_t>(str.size(), 0xffff);
+    writeU16(len);
+    stream->write(str.data(), len);
+}
+
+void
+Binary::writeU8(uint8_t val)
+{
+    stream->put(val);
+}
+
+void
+Binary::writeU16(uint16_t val)
+{
+    val = htole(val);
+    stream->write((const char *)&val, sizeof(val));
+}
+
+void
+Binary::writeU32(uint32_t val)
+{
+    val = htole(val);
+    stream->write((const char *)&val, sizeof(val));
+}
+
+void
+Binary::writeU64(uint64_t val)
+{
+    val = htole(val);
+    stream->write((const char *)&val, sizeof(val));
+}
+
+void
+Binary::visit(const ScalarInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const VectorInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const Vector2dInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const DistInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const VectorDistInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const FormulaInfo &info)
+{
+    add(info);
+}
+
+void
+Binary::visit(const SparseHistInfo &info)
+{
+    add(info);
+}
+
+Output *
+initBinary(const string &filename)
+{
+    static Binary binary;
+    static bool connected = false;
+
+    if (!connected) {
+        ostream *os = simout.find(filename);
+        if (!os)
+            os = simout.create(filename, true);
+
+        binary.open(*os);
+        connected = true;
+    }
+
+    return &binary;
+}
+
+} // namespace Stats
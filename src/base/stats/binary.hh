@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __BASE_STATS_BINARY_HH__
+#define __BASE_STATS_BINARY_HH__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+namespace Stats {
+
+/**
+ * Stats output in a compact binary format meant for runs that dump
+ * statistics many times.
+ *
+ * Every stat is flattened into scalar columns, named the same way the
+ * Text output names its lines. The schema grows as stats show up: the
+ * first time a stat is dumped, a schema record gives its column names
+ * and descriptions under the stat's id. Each dump is then a record of
+ * (stat id, values) pairs for just the stats it holds, so dumps that
+ * pick different stats never repeat the names. A stat is only defined
+ * again if its columns change, e.g. when a sparse histogram sees a new
+ * key or a histogram grows its buckets; the new definition replaces
+ * the old one for the dumps that follow. util/stats/binary.py reads
+ * these files.
+ *
+ * All integers and doubles are stored little-endian. The file starts
+ * with the 8 byte magic "gem5stat" and a uint32 version, followed by
+ * records that each start with a one byte tag:
+ *
+ *   'S' uint32 stat id, uint32 ncols,
+ *       then per column: string name, string desc
+ *   'D' uint64 tick, string desc, uint32 nstats,
+ *       then per stat: uint32 stat id, one double per column
+ *
+ * where a string is a uint16 length followed by that many bytes.
+ */
+class Binary : public Output
+{
+  public:
+    static const uint32_t Version = 2;
+
+  protected:
+    /** The columns contributed by one stat. */
+    struct Group
+    {
+        const Info *info;
+        size_t count;
+        /** Hash of the column names of a distribution, which are named
+         * after its buckets or keys, or 0 for other stats. */
+        size_t names;
+
+        Group() : info(NULL), count(0), names(0) {}
+
+        bool operator==(const Group &rhs) const
+        {
+            return info == rhs.info && count == rhs.count &&
+                names == rhs.names;
+        }
+
+        bool operator!=(const Group &rhs) const
+        {
+            return !(*this == rhs);
+        }
+    };
+
+    bool mystream;
+    std::ostream *stream;
+
+    /** Description of the dump in progress. */
+    std::string dumpDesc;
+    /** Column values of the dump in progress. */
+    VResult values;
+    /** Stats visited so far in the dump in progress. */
+    std::vector<Group> groups;
+    /** Per stat id: the columns the last schema record gave the stat,
+     * with a NULL info for stats that were never defined. */
+    std::vector<Group> schema;
+    /** Encoding buffer for a dump record. */
+    std::vector<char> record;
+    /** Scratch space for the column names of a distribution. */
+    std::vector<std::string> distNames;
+    std::vector<std::string> distDescs;
+
+  protected:
+    /**
+     * Append the columns of a stat to the dump in progress. Unlike the
+     * text output, zero prerequisites don't hide a stat here; keeping
+     * the columns stable is what lets dumps skip the schema.
+     */
+    void add(const Info &info);
+
+    void writeHeader();
+    void writeSchema(const Group &group);
+    void append(const void *data, size_t len);
+    void writeString(const std::string &str);
+    void writeU8(uint8_t val);
+    void writeU16(uint16_t val);
+    void writeU32(uint32_t val);
+    void writeU64(uint64_t val);
+
+  public:
+    Binary();
+    Binary(const std::string &file);
+    ~Binary();
+
+    void open(std::ostream &stream);
+    void open(const std::string &file);
+
+    // Implement Visit
+    virtual void visit(const ScalarInfo &info);
+    virtual void visit(const VectorInfo &info);
+    virtual void visit(const DistInfo &info);
+    virtual void visit(const VectorDistInfo &info);
+    virtual void visit(const Vector2dInfo &info);
+    virtual void visit(const FormulaInfo &info);
+    virtual void visit(const SparseHistInfo &info);
+
+    // Implement Output
+    virtual bool valid() const;
+    virtual void begin(std::string desc="");
+    virtual void end();
+};
+
+Output *initBinary(const std::string &filename);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_BINARY_HH__
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <fnmatch.h>
+
+#include <cstring>
+
+#include "base/stats/dump_filter.hh"
+#include "base/stats/flatten.hh"
+#include "base/stats/info.hh"
+#include "base/statistics.hh"
+
+using namespace std;
+
+namespace Stats {
+
+void
+DumpFilter::setPatterns(const list<Info *> &stats,
+                        const vector<string> &include)
+{
+    patterns = include;
+    matches.assign(matches.size(), false);
+
+    list<Info *>::const_iterator i;
+    for (i = stats.begin(); i != stats.end(); ++i) {
+        const Info *info = *i;
+        if (info->id >= matches.size())
+            matches.resize(info->id + 1, false);
+
+        for (off_type p = 0; p < patterns.size(); ++p) {
+            if (fnmatch(patterns[p].c_str(), info->name.c_str(), 0) == 0) {
+                matches[info->id] = true;
+                break;
+            }
+        }
+    }
+}
+
+bool
+DumpFilter::changed(const Info &info)
+{
+    if (info.id >= dumped.size()) {
+        dumped.resize(info.id + 1, false);
+        lastValues.resize(info.id + 1);
+    }
+
+    scratch.clear();
+    flatten(info, scratch);
+
+    // Compare the bits rather than the values so that a stat that stays
+    // NaN doesn't count as changed.
+    VResult &last = lastValues[info.id];
+    bool same = dumped[info.id] && last.size() == scratch.size() &&
+        memcmp(last.data(), scratch.data(),
+               scratch.size() * sizeof(Result)) == 0;
+
+    last.swap(scratch);
+    dumped[info.id] = true;
+    return !same;
+}
+
+void
+DumpFilter::select(const list<Info *> &stats, bool changed_only,
+                   const vector<string> &include, vector<int> &ids)
+{
+    if (include != patterns)
+        setPatterns(stats, include);
+
+    // Previous values are only worth keeping while consecutive dumps
+    // compare against them; after a full dump every stat is due again.
+    if (!changed_only) {
+        dumped.clear();
+        lastValues.clear();
+    }
+
+    ids.clear();
+    list<Info *>::const_iterator i;
+    for (i = stats.begin(); i != stats.end(); ++i) {
+        const Info *info = *i;
+        if (!info->flags.isSet(display))
+            continue;
+        if (!patterns.empty() && !matches[info->id])
+            continue;
+        if (changed_only && !changed(*info))
+            continue;
+        ids.push_back(info->id);
+    }
+}
+
+vector<int>
+selectStats(bool changed_only, const vector<string> &include)
+{
+    static DumpFilter filter;
+
+    vector<int> ids;
+    filter.select(statsList(), changed_only, include, ids);
+    return ids;
+}
+
+} // namespace Stats
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __BASE_STATS_DUMP_FILTER_HH__
+#define __BASE_STATS_DUMP_FILTER_HH__
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "base/stats/types.hh"
+
+namespace Stats {
+
+class Info;
+
+/**
+ * Chooses the stats a dump emits. A dump can be limited to the stats
+ * whose names match one of a list of glob patterns, and to the stats
+ * whose values changed since the previous changed-only dump that
+ * looked at them. Stats that are reset after every dump and stay idle
+ * in between therefore drop out of the output entirely.
+ *
+ * Only stats that match the patterns are flattened, and previous values
+ * are only kept across changed-only dumps; after a full dump every stat
+ * counts as changed.
+ */
+class DumpFilter
+{
+  protected:
+    /** Patterns the matches below were computed for. */
+    std::vector<std::string> patterns;
+    /** Per stat id: whether the stat matches patterns. */
+    std::vector<bool> matches;
+
+    /** Per stat id: whether lastValues holds a previous dump. */
+    std::vector<bool> dumped;
+    /** Per stat id: the flattened values at the previous changed-only
+     * dump that looked at the stat. */
+    std::vector<VResult> lastValues;
+    VResult scratch;
+
+    void setPatterns(const std::list<Info *> &stats,
+                     const std::vector<std::string> &include);
+    bool changed(const Info &info);
+
+  public:
+    /**
+     * Pick the stats for a dump.
+     *
+     * @param stats Stats to choose from, in the order to dump them.
+     * @param changed_only Only pick stats whose values changed.
+     * @param include Glob patterns for the stat names to pick; empty
+     *        picks every stat.
+     * @param ids Filled with the ids of the chosen stats.
+     */
+    void select(const std::list<Info *> &stats, bool changed_only,
+                const std::vector<std::string> &include,
+                std::vector<int> &ids);
+};
+
+/**
+ * Run the global stats list through a shared DumpFilter and return the
+ * ids of the stats the next dump should emit.
+ */
+std::vector<int> selectStats(bool changed_only,
+                             const std::vector<std::string> &include);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_DUMP_FILTER_HH__
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include "base/stats/flatten.hh"
+#include "base/stats/info.hh"
+#include "base/misc.hh"
+
+using namespace std;
+
+namespace Stats {
+
+namespace {
+
+/**
+ * Collects the columns a stat flattens into. Names and descriptions
+ * are only built when a schema record is being written; a regular
+ * dump just gathers the values.
+ */
+class Columns
+{
+  private:
+    VResult &values;
+    vector<string> *names;
+    vector<string> *descs;
+
+    string prefix;
+    string desc;
+
+  public:
+    Columns(VResult &_values, vector<string> *_names = NULL,
+            vector<string> *_descs = NULL)
+        : values(_values), names(_names), descs(_descs)
+    { }
+
+    bool named() const { return names != NULL; }
+
+    /** Name the columns that follow as name, sep and a suffix. */
+    void
+    setPrefix(const string &name, const string &sep, const string &_desc)
+    {
+        if (named()) {
+            prefix = name + sep;
+            desc = _desc;
+        }
+    }
+
+    void
+    add(Result value, const string &suffix, const string &_desc)
+    {
+        values.push_back(value);
+        if (named()) {
+            names->push_back(prefix + suffix);
+            descs->push_back(_desc.empty() ? desc : _desc);
+        }
+    }
+
+    template <class T>
+    void
+    add(Result value, const T &suffix)
+    {
+        values.push_back(value);
+        if (named()) {
+            stringstream name;
+            name << prefix << suffix;
+            names->push_back(name.str());
+            descs->push_back(desc);
+        }
+    }
+
+    void
+    addBucket(Result value, Counter low, Counter high)
+    {
+        values.push_back(value);
+        if (named()) {
+            stringstream name;
+            name << prefix << low;
+            if (low < high)
+                name << "-" << high;
+            names->push_back(name.str());
+            descs->push_back(desc);
+        }
+    }
+};
+
+void
+flatten(const ScalarInfo &info, Columns &cols)
+{
+    cols.setPrefix(info.name, "", info.desc);
+    cols.add(info.result(), "");
+}
+
+void
+flatten(const VectorInfo &info, Columns &cols)
+{
+    size_type size = info.size();
+    const VResult &vec = info.result();
+
+    if (size == 1) {
+        cols.setPrefix(info.name, "", info.desc);
+        cols.add(vec[0], "");
+    } else {
+        cols.setPrefix(info.name, info.separatorString, info.desc);
+
+        bool havesub = false;
+        for (off_type i = 0; i < info.subnames.size(); ++i)
+            havesub = havesub || !info.subnames[i].empty();
+
+        for (off_type i = 0; i < size; ++i) {
+            if (!havesub) {
+                cols.add(vec[i], i);
+            } else if (i < info.subnames.size() &&
+                       !info.subnames[i].empty()) {
+                cols.add(vec[i], info.subnames[i],
+                         i < info.subdescs.size() ? info.subdescs[i] : "");
+            }
+        }
+    }
+
+    if (info.flags.isSet(::Stats::total)) {
+        cols.setPrefix(info.name, info.separatorString, info.desc);
+        cols.add(info.total(), "total");
+    }
+}
+
+void
+flatten(const Vector2dInfo &info, Columns &cols)
+{
+    bool havesub = false;
+    for (off_type i = 0; i < info.subnames.size(); ++i)
+        havesub = havesub || !info.subnames[i].empty();
+
+    Result super_total = 0.0;
+    for (off_type i = 0; i < info.x; ++i) {
+        if (havesub && (i >= info.subnames.size() || info.subnames[i].empty()))
+            continue;
+
+        if (cols.named()) {
+            cols.setPrefix(info.name + "_" +
+                           (havesub ? info.subnames[i] : to_string(i)),
+                           info.separatorString, info.desc);
+        }
+
+        Result total = 0.0;
+        for (off_type j = 0; j < info.y; ++j) {
+            Result value = info.cvec[i * info.y + j];
+            total += value;
+            if (j < info.y_subnames.size() && !info.y_subnames[j].empty())
+                cols.add(value, info.y_subnames[j], "");
+            else
+                cols.add(value, j);
+        }
+        super_total += total;
+
+        if (info.flags.isSet(::Stats::total))
+            cols.add(total, "total", "");
+    }
+
+    if (info.flags.isSet(::Stats::total) && info.x > 1) {
+        cols.setPrefix(info.name, info.separatorString, info.desc);
+        cols.add(super_total, "total", "");
+    }
+}
+
+void
+flatten(const DistData &data, Columns &cols)
+{
+    if (data.type != Deviation) {
+        cols.add(data.bucket_size, "bucket_size", "");
+        cols.add(data.min, "min_bucket", "");
+        cols.add(data.max, "max_bucket", "");
+    }
+
+    cols.add(data.samples, "samples", "");
+    cols.add(data.samples ? data.sum / data.samples : NAN, "mean", "");
+    if (data.type == Hist) {
+        cols.add(data.samples ? exp(data.logs / data.samples) : NAN,
+                 "gmean", "");
+    }
+
+    Result stdev = NAN;
+    if (data.samples)
+        stdev = sqrt((data.samples * data.squares - data.sum * data.sum) /
+                     (data.samples * (data.samples - 1.0)));
+    cols.add(stdev, "stdev", "");
+
+    if (data.type == Deviation)
+        return;
+
+    Result total = 0.0;
+    if (data.type == Dist) {
+        cols.add(data.underflow, "underflows", "");
+        total += data.underflow;
+    }
+
+    for (off_type i = 0; i < data.cvec.size(); ++i) {
+        Counter low = i * data.bucket_size + data.min;
+        Counter high = ::min(low + data.bucket_size - 1.0, data.max);
+        cols.addBucket(data.cvec[i], low, high);
+        total += data.cvec[i];
+    }
+
+    if (data.type == Dist) {
+        cols.add(data.overflow, "overflows", "");
+        total += data.overflow;
+        cols.add(data.min_val, "min_value", "");
+        cols.add(data.max_val, "max_value", "");
+    }
+
+    cols.add(total, "total", "");
+}
+
+void
+flatten(const DistInfo &info, Columns &cols)
+{
+    cols.setPrefix(info.name, info.separatorString, info.desc);
+    flatten(info.data, cols);
+}
+
+void
+flatten(const VectorDistInfo &info, Columns &cols)
+{
+    for (off_type i = 0; i < info.size(); ++i) {
+        if (cols.named()) {
+            const string &subname = info.subnames[i];
+            const string &subdesc = info.subdescs[i];
+            cols.setPrefix(info.name + "_" +
+                           (subname.empty() ? to_string(i) : subname),
+                           info.separatorString,
+                           subdesc.empty() ? info.desc : subdesc);
+        }
+        flatten(info.data[i], cols);
+    }
+}
+
+void
+flatten(const SparseHistInfo &info, Columns &cols)
+{
+    cols.setPrefix(info.name, info.separatorString, info.desc);
+    cols.add(info.data.samples, "samples", "");
+
+    MCounter::const_iterator it;
+    for (it = info.data.cmap.begin(); it != info.data.cmap.end(); ++it)
+        cols.add(it->second, it->first);
+}
+
+} // anonymous namespace
+
+void
+flatten(const Info &info, VResult &values, vector<string> *names,
+        vector<string> *descs)
+{
+    Columns cols(values, names, descs);
+
+    // FormulaInfo derives from VectorInfo and is flattened as one.
+    if (const ScalarInfo *scalar = dynamic_cast<const ScalarInfo *>(&info))
+        flatten(*scalar, cols);
+    else if (const VectorInfo *vec = dynamic_cast<const VectorInfo *>(&info))
+        flatten(*vec, cols);
+    else if (const Vector2dInfo *vec2d =
+             dynamic_cast<const Vector2dInfo *>(&info))
+        flatten(*vec2d, cols);
+    else if (const DistInfo *dist = dynamic_cast<const DistInfo *>(&info))
+        flatten(*dist, cols);
+    else if (const VectorDistInfo *vdist =
+             dynamic_cast<const VectorDistInfo *>(&info))
+        flatten(*vdist, cols);
+    else if (const SparseHistInfo *hist =
+             dynamic_cast<const SparseHistInfo *>(&info))
+        flatten(*hist, cols);
+    else
+        panic("Can't flatten statistic %s of unknown type\n", info.name);
+}
+
+} // namespace Stats
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "cpu/acc_task_data.hh"
+
+AccTaskDataRegistry::AccTaskDataRegistry(unsigned line_size)
+    : lineSize(line_size)
+{
+    assert(isPowerOf2(lineSize));
+}
+
+void
+AccTaskDataRegistry::addRange(Addr start, Addr size)
+{
+    Addr first_line = lineAlign(start);
+    Addr end_line = roundUp(start + size, lineSize);
+
+    // Drop every buffer whose lines overlap the new one. Only the buffer
+    // right before first_line can reach into it from below.
+    auto it = regions.lower_bound(first_line);
+    if (it != regions.begin()) {
+        auto prev = std::prev(it);
+        if (roundUp(prev->second.end, lineSize) > first_line)
+            it = prev;
+    }
+    while (it != regions.end() && it->first < end_line) {
+        warn("Task data buffer %#x-%#x replaces %#x-%#x.\n",
+             start, start + size, it->second.start, it->second.end);
+        it = regions.erase(it);
+    }
+
+    size_t num_lines = (end_line - first_line) / lineSize;
+    Region &region = regions[first_line];
+    region.start = start;
+    region.end = start + size;
+    region.bytesWritten.assign(num_lines, 0);
+    registeredRanges++;
+}
+
+void
+AccTaskDataRegistry::clear()
+{
+    regions.clear();
+}
+
+const AccTaskDataRegistry::Region *
+AccTaskDataRegistry::findLine(Addr line_vaddr, size_t &line) const
+{
+    if (regions.empty())
+        return nullptr;
+
+    auto it = regions.upper_bound(line_vaddr);
+    if (it == regions.begin())
+        return nullptr;
+    --it;
+
+    line = (line_vaddr - it->first) / lineSize;
+    if (line >= it->second.bytesWritten.size())
+        return nullptr;
+    return &it->second;
+}
+
+AccTaskDataRegistry::Region *
+AccTaskDataRegistry::findLine(Addr line_vaddr, size_t &line)
+{
+    const AccTaskDataRegistry *self = this;
+    return const_cast<Region *>(self->findLine(line_vaddr, line));
+}
+
+bool
+AccTaskDataRegistry::contains(Addr vaddr) const
+{
+    size_t line;
+    const Region *region = findLine(lineAlign(vaddr), line);
+    return region && vaddr >= region->start && vaddr < region->end;
+}
+
+bool
+AccTaskDataRegistry::recordWrite(Addr line_vaddr, unsigned bytes)
+{
+    size_t line;
+    Region *region = findLine(line_vaddr, line);
+    if (!region)
+        return false;
+
+    region->bytesWritten[line] =
+        std::min<unsigned>(region->bytesWritten[line] + bytes, lineSize);
+    writeBytes += bytes;
+    return true;
+}
+
+bool
+AccTaskDataRegistry::recordEviction(Addr line_vaddr, bool use_counter)
+{
+    size_t line;
+    Region *region = findLine(line_vaddr, line);
+    if (!region)
+        return false;
+
+    if (use_counter && region->bytesWritten[line] >= lineSize) {
+        fullLineEvictions++;
+        return true;
+    }
+
+    evictions++;
+    return true;
+}
+
+void
+AccTaskDataRegistry::regStats(const std::string &name)
+{
+    registeredRanges
+        .name(name + ".accTaskDataRanges")
+        .desc("number of accelerator task data buffers registered")
+        ;
+
+    writeBytes
+        .name(name + ".accTaskDataWriteBytes")
+        .desc("number of bytes written to accelerator task data")
+        ;
+
+    evictions
+        .name(name + ".accTaskDataEvictions")
+        .desc("number of accelerator task data lines evicted")
+        ;
+
+    fullLineEvictions
+        .name(name + ".accTaskDataFullLineEvictions")
+        .desc("number of fully written accelerator task data lines evicted")
+        ;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __CPU_ACC_TASK_DATA_HH__
+#define __CPU_ACC_TASK_DATA_HH__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+
+/**
+ * Registry of the buffers a CPU produces for an accelerator (its task
+ * data). Caches consult it to recognise lines that belong to one of the
+ * registered buffers, so they can be forwarded to the accelerator on
+ * eviction.
+ *
+ * The buffers are kept in an interval map keyed by their first cache
+ * line. Each buffer counts the bytes written to each of its lines so
+ * far. Lookups are
+ * logarithmic in the number of registered buffers and constant in their
+ * size.
+ */
+class AccTaskDataRegistry
+{
+  public:
+    AccTaskDataRegistry(unsigned line_size);
+
+    /**
+     * Register a buffer. Any registered buffer sharing a cache line
+     * with it is dropped.
+     */
+    void addRange(Addr start, Addr size);
+
+    /** Forget all buffers. */
+    void clear();
+
+    bool empty() const { return regions.empty(); }
+
+    /** Does the byte at vaddr belong to a registered buffer? */
+    bool contains(Addr vaddr) const;
+
+    /**
+     * Record a write of @p bytes bytes to the line at @p line_vaddr.
+     * Returns false if the line does not belong to a registered buffer.
+     */
+    bool recordWrite(Addr line_vaddr, unsigned bytes);
+
+    /**
+     * Handle the eviction of the line at @p line_vaddr.
+     *
+     * @param use_counter Whether the cache tracks per-line write
+     *                    counters. Fully written lines are then counted
+     *                    separately.
+     * @return Whether the line is task data that should be forwarded.
+     */
+    bool recordEviction(Addr line_vaddr, bool use_counter);
+
+    void regStats(const std::string &name);
+
+  private:
+    struct Region
+    {
+        /** Exact extent of the buffer, [start, end). */
+        Addr start;
+        Addr end;
+        /** Bytes written to each line, saturated at the line size. */
+        std::vector<uint16_t> bytesWritten;
+    };
+
+    typedef std::map<Addr, Region> RegionMap;
+
+    /**
+     * Find the buffer covering a line and the index of the line within
+     * it. Returns nullptr if no buffer covers the line.
+     */
+    const Region *findLine(Addr line_vaddr, size_t &line) const;
+    Region *findLine(Addr line_vaddr, size_t &line);
+
+    Addr lineAlign(Addr vaddr) const { return vaddr & ~Addr(lineSize - 1); }
+
+    const unsigned lineSize;
+
+    /** Buffers keyed by the address of their first line. */
+    RegionMap regions;
+
+    Stats::Scalar registeredRanges;
+    Stats::Scalar writeBytes;
+    Stats::Scalar evictions;
+    Stats::Scalar fullLineEvictions;
+};
+
+#endif // __CPU_ACC_TASK_DATA_HH__
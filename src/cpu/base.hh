@@ -150,12 +150,6 @@ class BaseCPU : public MemObject
     /** Cache the cache line size that we get from the system */
     const unsigned int _cacheLineSize;
 
-    /** Record the current Acc-ask data address range*/
-    Addr _accTaskDataStart;
-    size_t _accTaskDataSize;
-    std::unordered_map<Addr, size_t> accTaskDataCtr;
-    std::unordered_set<Addr> accTaskDataInCache;
-
   public:
 
     /**
@@ -213,53 +207,6 @@ class BaseCPU : public MemObject
 
     TheISA::MicrocodeRom microcodeRom;
 
-    void setAccTaskDataRange(Addr start, size_t size) { 
-      _accTaskDataStart = start; 
-      _accTaskDataSize = size;
-      accTaskDataCtr.clear();
-    }
-
-    bool checkAccTaskData(Addr vaddr) {
-      return (vaddr >= _accTaskDataStart && 
-              vaddr <= (_accTaskDataStart + (Addr)_accTaskDataSize));}
-
-    std::pair<Addr, Addr> getAccTaskDataRange() {
-      return std::make_pair(_accTaskDataStart, 
-                       _accTaskDataStart + (Addr)_accTaskDataSize);}
-
-    void incAccTaskDataCtr(Addr vaddr, unsigned int bytes) {
-      if(accTaskDataCtr.find(vaddr) == accTaskDataCtr.end()) {
-        accTaskDataCtr.insert(std::make_pair(vaddr, bytes));
-      } else {
-        accTaskDataCtr[vaddr] += bytes;
-      }
-    }
-
-    void incAccTaskDataInCache(Addr vaddr) {
-      if(accTaskDataInCache.find(vaddr) == accTaskDataInCache.end()) {
-        accTaskDataInCache.insert(vaddr);
-      }
-    }
-
-    void decAccTaskDataInCache(Addr vaddr) {
-      if(accTaskDataInCache.find(vaddr) != accTaskDataInCache.end()) {
-        accTaskDataInCache.erase(vaddr);
-      }
-    }
-
-    bool checkAccTaskDataInCache(Addr vaddr) {
-      return (accTaskDataInCache.find(vaddr) != accTaskDataInCache.end()); 
-    }
-
-    bool checkAccTaskDataCtr(Addr vaddr){
-      if(accTaskDataCtr.find(vaddr) == accTaskDataCtr.end()) {
-        return false;
-      } else {
-        printf("# of written bytes for Acc-task Data %x: %u\n", vaddr, accTaskDataCtr[vaddr]);
-        return (accTaskDataCtr[vaddr] >= cacheLineSize() ? true : false);
-      }
-    }
-
   protected:
     TheISA::Interrupts *interrupts;
 
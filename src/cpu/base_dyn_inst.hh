@@ -926,8 +926,6 @@ BaseDynInst<Impl>::readMem(Addr addr, uint8_t *data,
     return fault;
 }
 
-static unsigned totalAccTaskSize = 0;
-extern bool forwardAccTaskData;
 
 template<class Impl>
 Fault
@@ -956,12 +954,9 @@ BaseDynInst<Impl>::writeMem(uint8_t *data, unsigned size,
         if (TheISA::HasUnalignedMemAcc) {
             splitRequest(req, sreqLow, sreqHigh);
         }
-        auto range = cpu->getAccTaskDataRange();
-        if(forwardAccTaskData && cpu->checkAccTaskData(req->getVaddr())) {
-          auto range = cpu->getAccTaskDataRange();
-          totalAccTaskSize += req->getSize();
-          printf("Write req %x fall in Acc-task data range %x - %x, accumulated bytes: %u\n", 
-                 req->getVaddr(), range.first, range.second, totalAccTaskSize);
+        AccTaskDataRegistry *acc_task_data =
+            cpu->system->forwardedAccTaskData(thread->contextId());
+        if(acc_task_data && acc_task_data->contains(req->getVaddr())) {
           req->setFlags(Request::ACC_TASK_DATA);
           if(sreqLow != NULL) {
             sreqLow->setFlags(Request::ACC_TASK_DATA);
@@ -49,6 +49,12 @@ class DmaDevice(PioDevice):
     cxx_header = "dev/io_device.hh"
     abstract = True
     dma = MasterPort("DMA port")
+    dma_channels = Param.Unsigned(64, "Number of DMA channels, transactions "
+                                  "wait for a free channel when all are busy")
+    dma_burst_size = Param.Unsigned(0, "Bytes of contiguous DMA data sent as "
+                                    "one burst packet, 0 to disable. Lines "
+                                    "are sent instead if a cache could see "
+                                    "the bursts")
 
 
 class IsaFake(BasicPioDevice):
@@ -46,6 +46,8 @@
 #include "debug/DMA.hh"
 #include "debug/Drain.hh"
 #include "dev/dma_device.hh"
+#include "mem/cache/base.hh"
+#include "mem/coherent_xbar.hh"
 #include "sim/system.hh"
 
 extern int NumDMAReq;
@@ -55,22 +57,72 @@ std::unordered_set<uint64_t> Evictions;
 
 DmaPort::DmaPort(MemObject *dev, System *s, unsigned max_req,
                  unsigned _chunkSize, bool _multiChannel,
-                 bool _invalidateOnWrite)
-    : MasterPort(dev->name() + ".dma", dev), device(dev), sendEvent(this),
+                 bool _invalidateOnWrite, unsigned num_channels,
+                 unsigned burst_size)
+    : MasterPort(dev->name() + ".dma", dev), device(dev),
+      channels(num_channels), sendEvent(this),
       sys(s), masterId(s->getMasterId(dev->name())),
       pendingCount(0), drainManager(NULL),
       inRetry(false), maxRequests(max_req),
-      chunkSize(_chunkSize),
+      chunkSize(_chunkSize), burstSize(burst_size),
       multiChannel(_multiChannel),
-      invalidateOnWrite(_invalidateOnWrite)
+      invalidateOnWrite(_invalidateOnWrite),
+      invalidateReqState(nullptr, 0, 0, 0)
 {
+  fatal_if(num_channels == 0 || num_channels > MAX_CHANNELS,
+           "%s: number of DMA channels must be between 1 and %d, got %d\n",
+           name(), MAX_CHANNELS, num_channels);
+  fatal_if(burstSize && (burstSize <= chunkSize || !isPowerOf2(burstSize)),
+           "%s: DMA burst size %d must be a power of 2 larger than the "
+           "chunk size %d\n", name(), burstSize, chunkSize);
   numOutstandingRequests = 0;
-  currChannelIdx = 0;
-  DPRINTF(DMA, "Setting up DMA with transaction chunk size %d\n", chunkSize);
+
+  // Hand out the lowest channel indices first.
+  freeChannels.reserve(num_channels);
+  for (unsigned i = num_channels; i > 0; --i)
+      freeChannels.push_back(i - 1);
+
+  // The stats are sized here so that they can be updated even if the
+  // owner never registers them; regStats only names them.
+  channelActions.init(num_channels);
+  channelBusyTicks.init(num_channels);
+  poolHeapAllocations.method(this, &DmaPort::heapAllocations);
+
+  DPRINTF(DMA, "Setting up DMA with transaction chunk size %d, burst size "
+          "%d and %d channels\n", chunkSize, burstSize, num_channels);
 }
 
 DmaPort::DmaPort(MemObject *dev, System *s, unsigned max_req)
-    : DmaPort(dev, s, max_req, sys->cacheLineSize(), false) {}
+    : DmaPort(dev, s, max_req, s->cacheLineSize(), false) {}
+
+void
+DmaPort::regStats()
+{
+    using namespace Stats;
+    channelActions
+        .name(name() + ".channel_actions")
+        .desc("Number of DMA transactions served by each channel")
+        .flags(total | nozero)
+        ;
+    channelBusyTicks
+        .name(name() + ".channel_busy_ticks")
+        .desc("Number of ticks each channel had a transaction bound")
+        .flags(total | nozero)
+        ;
+    channelStalls
+        .name(name() + ".channel_stalls")
+        .desc("Number of DMA transactions that waited for a free channel")
+        ;
+    burstPackets
+        .name(name() + ".burst_packets")
+        .desc("Number of DMA packets that carry a multi-line burst")
+        ;
+    poolHeapAllocations
+        .name(name() + ".pool_heap_allocations")
+        .desc("Number of requests, packets and states allocated from the "
+              "heap rather than recycled")
+        ;
+}
 
 void
 DmaPort::handleResp(PacketPtr pkt, Tick delay)
@@ -101,17 +153,21 @@ DmaPort::handleResp(PacketPtr pkt, Tick delay)
     assert(state->totBytes >= state->numBytes);
 
     // if we have reached the total number of bytes for this DMA
-    // request, then signal the completion and delete the sate
+    // request, then signal the completion, and recycle the channel
     if (state->totBytes == state->numBytes) {
         if (state->completionEvent) {
             delay += state->delay;
             device->schedule(state->completionEvent, curTick() + delay);
         }
+        if (state->channel >= 0)
+            releaseChannel(state->channel);
+        if (state->ownedByPort)
+            statePool.release(state);
     }
 
-    // delete the request that we created and also the packet
-    delete pkt->req;
-    delete pkt;
+    // recycle the request that we created and also the packet
+    requestPool.release(pkt->req);
+    packetPool.release(pkt);
 
     // we might be drained at this point, if so signal the drain event
     if (pendingCount == 0 && drainManager) {
@@ -133,7 +189,10 @@ DmaPort::recvTimingResp(PacketPtr pkt)
 }
 
 DmaDevice::DmaDevice(const Params *p)
-    : PioDevice(p), dmaPort(this, sys, MAX_DMA_REQUEST) //Modification for DMA w/ Aladdin
+    : PioDevice(p),
+      dmaPort(this, sys, MAX_DMA_REQUEST, //Modification for DMA w/ Aladdin
+              sys->cacheLineSize(), false, false, p->dma_channels,
+              p->dma_burst_size)
 { }
 
 void
@@ -141,9 +200,17 @@ DmaDevice::init()
 {
     if (!dmaPort.isConnected())
         panic("DMA port of %s not connected to anything!", name());
+    dmaPort.checkBurstPath();
     PioDevice::init();
 }
 
+void
+DmaDevice::regStats()
+{
+    PioDevice::regStats();
+    dmaPort.regStats();
+}
+
 unsigned int
 DmaDevice::drain(DrainManager *dm)
 {
@@ -165,10 +232,54 @@ DmaPort::drain(DrainManager *dm)
     return 1;
 }
 
+/**
+ * Could a packet sent to a memory object reach a cache, either directly
+ * or as a snoop? Crossbars are followed towards their slaves.
+ */
+static bool
+reachesCache(MemObject &obj, int depth)
+{
+    if (dynamic_cast<BaseCache *>(&obj))
+        return true;
+
+    BaseXBar *xbar = dynamic_cast<BaseXBar *>(&obj);
+    if (!xbar)
+        return false;
+
+    CoherentXBar *coherent = dynamic_cast<CoherentXBar *>(xbar);
+    if (coherent && coherent->hasSnoopers())
+        return true;
+
+    // the memory system is a tree below the device, so this ends, but
+    // stay on the safe side should it not be
+    if (depth == 0)
+        return true;
+    for (const auto& p: xbar->getMasterPorts()) {
+        if (p->isConnected() &&
+            reachesCache(p->getSlavePort().getOwner(), depth - 1))
+            return true;
+    }
+    return false;
+}
+
+void
+DmaPort::checkBurstPath()
+{
+    if (!burstSize)
+        return;
+
+    MemObject &peer = getSlavePort().getOwner();
+    if (reachesCache(peer, 8)) {
+        warn("%s: DMA bursts could be seen by a cache behind %s, sending "
+             "%d byte packets instead\n", name(), peer.name(), chunkSize);
+        burstSize = 0;
+    }
+}
+
 void
 DmaPort::recvReqRetry()
 {
-    assert(transmitList.size());
+    assert(!readyChannels.empty());
     trySendTimingReq();
 }
 
@@ -179,7 +290,8 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
     // one DMA request sender state for every action, that is then
     // split into many requests and packets based on the block size,
     // i.e. cache line size
-    DmaReqState *reqState = new DmaReqState(event, size, addr, delay);
+    DmaReqState *reqState = statePool.allocate(event, size, addr, delay);
+    reqState->ownedByPort = true;
 
     // (functionality added for Table Walker statistics)
     // We're only interested in this when there will only be one request.
@@ -190,42 +302,34 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
     DPRINTF(DMA, "Starting DMA for addr: %#x size: %d sched: %d\n",
             addr, size, event ? event->scheduled() : -1);
 
-    /* TODO: Ideally the number of DMA channels should be a fixed hardware
-     * constraint, instead of growing up and down at runtime. A better way to do
-     * this is to allocate a fixed-number of channels when we initialize the DMA
-     * device. We will swtich to that after MICRO. */
-    transmitList.push_back(std::pair<DmaReqState *, std::deque<PacketPtr> >
-                               (reqState, std::deque<PacketPtr>()));
-    assert (transmitList.size() < MAX_CHANNELS);
-    unsigned channel_idx = transmitList.size() - 1;
+    // Take a channel from the pool. If they are all busy, the packets
+    // are parked with the transaction until a channel is recycled.
+    int channel_idx = allocateChannel(reqState);
+    if (channel_idx < 0)
+        waitForChannel(reqState);
 
     MemCmd memcmd(cmd);
-    if (invalidateOnWrite && memcmd.isWrite()) {
-      // Invalidation requests have no completion events, generate no
-      // responses, and do not transmit data.
-      DmaReqState *invalidateReqState = new DmaReqState(nullptr, 0, addr, delay);
-      for (ChunkGenerator gen(addr, size, sys->cacheLineSize());
-           !gen.done(); gen.next()) {
-          req = new Request(gen.addr(), gen.size(), flag, masterId);
-          req->taskId(ContextSwitchTaskId::DMA);
-          PacketPtr pkt = new Packet(req, MemCmd::InvalidationReq);
-          pkt->senderState = invalidateReqState;
-
-          DPRINTF(DMA, "--Queuing invalidation request for addr: %#x size: %d in channel %d\n",
-                  gen.addr(), gen.size(), channel_idx);
-          queueDma(channel_idx, pkt);
-      }
-    } 
-
-    /* TODO: Currently as we dynamically add channels, the channel ID is the
-     * last channel that is just added. If we switch to the fixed-number of
-     * channels model, we can let users to pick which channel they want to use,
-     * or automatically pick the empty channel. */
-    for (ChunkGenerator gen(addr, size, chunkSize);
+    if (invalidateOnWrite && memcmd.isWrite())
+        queueInvalidation(reqState, addr, size, flag);
+
+    // In burst mode, the contiguous chunks of a read or write travel as
+    // one packet, and the memory models the timing of each line.
+    unsigned pkt_size = chunkSize;
+    Request::Flags pkt_flag = flag;
+    if (burstSize && (memcmd.isRead() || memcmd.isWrite()) &&
+        (unsigned)size > chunkSize) {
+        pkt_size = burstSize;
+        pkt_flag.set(Request::DMA_BURST);
+    }
+
+    for (ChunkGenerator gen(addr, size, pkt_size);
          !gen.done(); gen.next()) {
-        req = new Request(gen.addr(), gen.size(), flag, masterId);
+        req = requestPool.allocate(gen.addr(), gen.size(), pkt_flag,
+                                   masterId);
         req->taskId(ContextSwitchTaskId::DMA);
-        PacketPtr pkt = new Packet(req, cmd);
+        PacketPtr pkt = packetPool.allocate(req, cmd);
+        if (gen.size() > chunkSize)
+            burstPackets++;
 
         // Increment the data pointer on a write
         if (data)
@@ -235,24 +339,97 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
 
         DPRINTF(DMA, "--Queuing Cache DMA for addr: %#x size: %d in channel %d\n", gen.addr(),
                 gen.size(), channel_idx);
-        queueDma(channel_idx, pkt);
+        queueDma(reqState, pkt);
     }
-    DPRINTF(DMA, "Channel %d has %d requests to be sent\n", channel_idx, transmitList[channel_idx].second.size());
 
     // in zero time also initiate the sending of the packets we have
     // just created, for atomic this involves actually completing all
     // the requests
-    sendDma();
+    if (channel_idx >= 0) {
+        DPRINTF(DMA, "Channel %d has %d requests to be sent\n", channel_idx,
+                channels[channel_idx].packets.size());
+        sendDma();
+    }
 
     return req;
 }
 
+void
+DmaPort::waitForChannel(DmaReqState *reqState)
+{
+    channelStalls++;
+    waitingActions.push_back(std::make_pair(reqState,
+                                            std::deque<PacketPtr>()));
+    DPRINTF(DMA, "All %d channels are busy, %d transactions waiting\n",
+            channels.size(), waitingActions.size());
+}
+
+int
+DmaPort::allocateChannel(DmaReqState *reqState)
+{
+    if (freeChannels.empty())
+        return -1;
+
+    unsigned channel_idx = freeChannels.back();
+    freeChannels.pop_back();
+
+    DmaChannel &channel = channels[channel_idx];
+    assert(!channel.state && channel.packets.empty());
+    channel.state = reqState;
+    channel.allocTick = curTick();
+    reqState->channel = channel_idx;
+    channelActions[channel_idx]++;
+
+    return channel_idx;
+}
+
+void
+DmaPort::releaseChannel(unsigned channel_idx)
+{
+    DmaChannel &channel = channels[channel_idx];
+    assert(channel.packets.empty());
+    channelBusyTicks[channel_idx] += curTick() - channel.allocTick;
+    channel.state->channel = -1;
+    channel.state = nullptr;
+
+    if (waitingActions.empty()) {
+        freeChannels.push_back(channel_idx);
+        DPRINTF(DMA, "-- Channel %d is free\n", channel_idx);
+        return;
+    }
+
+    // Hand the channel over to the oldest waiting transaction. Its
+    // packets are already counted as pending.
+    DmaReqState *reqState = waitingActions.front().first;
+    channel.state = reqState;
+    channel.allocTick = curTick();
+    reqState->channel = channel_idx;
+    channelActions[channel_idx]++;
+    channel.packets.swap(waitingActions.front().second);
+    waitingActions.pop_front();
+
+    DPRINTF(DMA, "-- Channel %d now serves addr: %#x with %d requests\n",
+            channel_idx, reqState->addr, channel.packets.size());
+
+    if (!channel.packets.empty() && !channel.ready) {
+        channel.ready = true;
+        readyChannels.push_back(channel_idx);
+    }
+
+    // In timing mode nothing may be scheduled to send the newly ready
+    // packets, in atomic mode the sending loop picks them up.
+    if (sys->isTimingMode() && !inRetry && !sendEvent.scheduled())
+        device->schedule(sendEvent, device->clockEdge(Cycles(1)));
+}
+
 unsigned
 DmaPort::addNewChannel(DmaReqState *reqState){
-  transmitList.push_back(std::pair<DmaReqState *, std::deque<PacketPtr> >
-                             (reqState, std::deque<PacketPtr>()));
-  assert (transmitList.size() < MAX_CHANNELS);
-  return transmitList.size() - 1;
+  int channel_idx = allocateChannel(reqState);
+  if (channel_idx < 0) {
+      waitForChannel(reqState);
+      return WaitingChannel;
+  }
+  return channel_idx;
 }
 
 RequestPtr
@@ -265,27 +442,17 @@ DmaPort::dmaReqOnChannel(Packet::Command cmd, Addr addr, int size,
     MemCmd memcmd(cmd);
 
 
-    if (invalidateOnWrite && memcmd.isWrite()) {
-      // Invalidation requests have no completion events, generate no
-      // responses, and do not transmit data.
-      DmaReqState *invalidateReqState = new DmaReqState(nullptr, 0, addr, delay);
-      req = new Request(addr, size, flag, masterId);
-      req->taskId(ContextSwitchTaskId::DMA);
-      PacketPtr pkt = new Packet(req, MemCmd::InvalidationReq);
-      pkt->senderState = invalidateReqState;
-
-      DPRINTF(DMA, "--Queuing invalidation request for addr: %#x size: %d in channel %d\n",
-              addr, size, channel_idx);
-      queueDma(channel_idx, pkt);
-    } 
-
-    /* TODO: Currently as we dynamically add channels, the channel ID is the
-     * last channel that is just added. If we switch to the fixed-number of
-     * channels model, we can let users to pick which channel they want to use,
-     * or automatically pick the empty channel. */
-    req = new Request(addr, size, flag, masterId);
+    // The transaction may have been handed a channel since the caller
+    // was told it had to wait, so its own record is the one to follow.
+    assert(channel_idx == WaitingChannel || reqState->channel < 0 ||
+           channel_idx == (unsigned)reqState->channel);
+
+    if (invalidateOnWrite && memcmd.isWrite())
+        queueInvalidation(reqState, addr, size, flag);
+
+    req = requestPool.allocate(addr, size, flag, masterId);
     req->taskId(ContextSwitchTaskId::DMA);
-    PacketPtr pkt = new Packet(req, cmd);
+    PacketPtr pkt = packetPool.allocate(req, cmd);
 
     // Increment the data pointer on a write
     if (data)
@@ -294,16 +461,53 @@ DmaPort::dmaReqOnChannel(Packet::Command cmd, Addr addr, int size,
     pkt->senderState = reqState;
 
     DPRINTF(DMA, "--Queuing Cache DMA for addr: %#x size: %d in channel %d\n", addr,
-            size, channel_idx);
-    queueDma(channel_idx, pkt);
+            size, reqState->channel);
+    queueDma(reqState, pkt);
 
     return req;
 }
 
 void
-DmaPort::queueDma(unsigned channel_idx, PacketPtr pkt)
+DmaPort::queueInvalidation(DmaReqState *reqState, Addr addr, int size,
+                           Request::Flags flag)
 {
-    transmitList[channel_idx].second.push_back(pkt);
+    // Invalidation requests have no completion events, generate no
+    // responses, and do not transmit data. A single request covers all
+    // the cache lines that the write touches. Whoever ends up with the
+    // packet deletes it along with the request, so the request is not
+    // taken from the pool.
+    RequestPtr req = new Request(addr, size, flag, masterId);
+    req->taskId(ContextSwitchTaskId::DMA);
+    PacketPtr pkt = packetPool.allocate(req, MemCmd::InvalidateRangeReq);
+    pkt->senderState = &invalidateReqState;
+
+    DPRINTF(DMA, "--Queuing invalidation request for addr: %#x size: %d "
+            "in channel %d\n", addr, size, reqState->channel);
+    queueDma(reqState, pkt);
+}
+
+void
+DmaPort::queueDma(DmaReqState *reqState, PacketPtr pkt)
+{
+    int channel_idx = reqState->channel;
+    if (channel_idx < 0) {
+        // usually the transaction that just started waiting
+        auto waiting = waitingActions.rbegin();
+        while (waiting != waitingActions.rend() &&
+               waiting->first != reqState)
+            ++waiting;
+        panic_if(waiting == waitingActions.rend(),
+                 "%s: DMA transaction at %#x has no channel\n", name(),
+                 reqState->addr);
+        waiting->second.push_back(pkt);
+    } else {
+        DmaChannel &channel = channels[channel_idx];
+        channel.packets.push_back(pkt);
+        if (!channel.ready) {
+            channel.ready = true;
+            readyChannels.push_back(channel_idx);
+        }
+    }
 
     // remember that we have another packet pending, this will only be
     // decremented once a response comes back
@@ -313,66 +517,49 @@ DmaPort::queueDma(unsigned channel_idx, PacketPtr pkt)
 void
 DmaPort::switchToNextChannel()
 {
-	int nextChannelIdx;
-	unsigned num_channels = transmitList.size();
-	// If the current channel is empty, or DMA is in multi-channel mode,
-	// move on to the next channel.
-  DmaReqState *state = transmitList[currChannelIdx].first;
-	if (transmitList[currChannelIdx].second.empty() || multiChannel) {
-		nextChannelIdx = (currChannelIdx + 1) % num_channels;
-		// Check whether next channel is empty
-		state = transmitList[nextChannelIdx].first;
-		//while (transmitList[nextChannelIdx].empty()) {
-		while (!(state->totBytes > state->numBytes)) {
-			if (nextChannelIdx == currChannelIdx) {
-				// no more packet after this one.
-				nextChannelIdx = -1;
-				break;
-			} else {
-				nextChannelIdx = (nextChannelIdx + 1) % num_channels;
-				state = transmitList[nextChannelIdx].first;
-			}
-		}
-	} else {
-		// DMA is not interleaving, and there are more packets to send in curr
-		// channel.
-		nextChannelIdx = currChannelIdx;
-	}
-	// assign channel id.
-	currChannelIdx = nextChannelIdx;
-	// if there is more to do, then do so
-	if (currChannelIdx != -1) {
-		// this should ultimately wait for as many cycles as the
-		// device needs to send the packet, but currently the port
-		// does not have any known width so simply wait a single
-		// cycle
-		device->schedule(sendEvent, device->clockEdge(Cycles(1)));
-	  DPRINTF(DMA, "-- Switch to the next channel %d\n", currChannelIdx);
-    DPRINTF(DMA, "-- Channel %d, remaining requests: %d, total bytes: %d, issued bytes: %d\n", nextChannelIdx, transmitList[nextChannelIdx].second.size(), state->totBytes, state->numBytes);
-	} else {
-		// Reset the channel idx for the next transfer.
-		currChannelIdx = 0;
-		transmitList.clear();
-    DPRINTF(DMA, "-- All DMA actions are done\n");
-	}
-	DPRINTF(DMA, "-- Done\n");
+    assert(!readyChannels.empty());
+    unsigned channel_idx = readyChannels.front();
+    DmaChannel &channel = channels[channel_idx];
+
+    // If the current channel is empty, it leaves the ready queue. If DMA
+    // is in multi-channel mode, it goes to the back of the queue so that
+    // the channels are interleaved. Otherwise, the current channel keeps
+    // sending until it is empty.
+    if (channel.packets.empty()) {
+        readyChannels.pop_front();
+        channel.ready = false;
+    } else if (multiChannel) {
+        readyChannels.pop_front();
+        readyChannels.push_back(channel_idx);
+    }
+
+    // if there is more to do, then do so
+    if (!readyChannels.empty()) {
+        // this should ultimately wait for as many cycles as the
+        // device needs to send the packet, but currently the port
+        // does not have any known width so simply wait a single
+        // cycle
+        device->schedule(sendEvent, device->clockEdge(Cycles(1)));
+        DPRINTF(DMA, "-- Switch to the next channel %d, remaining "
+                "requests: %d\n", readyChannels.front(),
+                channels[readyChannels.front()].packets.size());
+    } else {
+        DPRINTF(DMA, "-- All DMA actions are done\n");
+    }
 }
 
 void
 DmaPort::trySendTimingReq()
 {
-    if (transmitList[currChannelIdx].second.empty()) {
-      DPRINTF(DMA, "Channel %d is empty(size: %d), switch to the next\n", currChannelIdx, transmitList[currChannelIdx].second.size());
-      switchToNextChannel();
-      return;
-    }
-    
-    // send the first packet on the transmit list and schedule the
-    // following send if it is successful
-    PacketPtr pkt = transmitList[currChannelIdx].second.front();
+    // send the first packet of the channel at the head of the ready
+    // queue and schedule the following send if it is successful
+    unsigned channel_idx = readyChannels.front();
+    DmaChannel &channel = channels[channel_idx];
+    assert(!channel.packets.empty());
+    PacketPtr pkt = channel.packets.front();
 
     DPRINTF(DMA, "Trying to send %s addr %#x of size %d on Channel %d\n", pkt->cmdString(),
-            pkt->getAddr(), pkt->req->getSize(), currChannelIdx);
+            pkt->getAddr(), pkt->req->getSize(), channel_idx);
     inRetry = !sendTimingReq(pkt);
     if (!inRetry) {
         if(pkt->isRead() && !pkt->isReadFromDRAM() &&
@@ -384,9 +571,10 @@ DmaPort::trySendTimingReq()
         if(!pkt->isReadFromDRAM())
           NumDMAReq++;
         // pop the first packet in the current channel
-        transmitList[currChannelIdx].second.pop_front();
-        DmaReqState *state = transmitList[currChannelIdx].first;
-        DPRINTF(DMA, "-- Channel %d, remaining requests: %d, total bytes: %d, issued bytes: %d\n", currChannelIdx, transmitList[currChannelIdx].second.size(), state->totBytes, state->numBytes);
+        channel.packets.pop_front();
+        DPRINTF(DMA, "-- Channel %d, remaining requests: %d, total bytes: %d, issued bytes: %d\n",
+                channel_idx, channel.packets.size(), channel.state->totBytes,
+                channel.state->numBytes);
 
 
         DPRINTF(DMA,
@@ -394,10 +582,10 @@ DmaPort::trySendTimingReq()
                 pkt->cmdString(),
                 pkt->getAddr(),
                 pkt->req->getSize(),
-                currChannelIdx);
+                channel_idx);
         // Invalidations do not have responses, so they complete as soon as
         // they send and do not count as an outstanding request.
-        if (pkt->cmd == MemCmd::InvalidationReq) {
+        if (pkt->isRangeInvalidate()) {
           pendingCount--;
         } else {
           numOutstandingRequests++;
@@ -409,8 +597,8 @@ DmaPort::trySendTimingReq()
         DPRINTF(DMA, "-- Failed, waiting for retry\n");
     }
 
-    DPRINTF(DMA, "TransmitList: %d, inRetry: %d\n",
-            transmitList.size(), inRetry);
+    DPRINTF(DMA, "Ready channels: %d, inRetry: %d\n",
+            readyChannels.size(), inRetry);
 }
 
 void
@@ -419,7 +607,8 @@ DmaPort::sendDma()
     // some kind of selcetion between access methods
     // more work is going to have to be done to make
     // switching actually work
-    assert(transmitList.size());
+    if (readyChannels.empty())
+        return;
 
     if (sys->isTimingMode()) {
         // if we are either waiting for a retry or are still waiting
@@ -436,22 +625,42 @@ DmaPort::sendDma()
         }
         trySendTimingReq();
     } else if (sys->isAtomicMode()) {
-        // send everything there is to send in zero time
-        for (auto it : transmitList) {
-          while(!it.second.empty()){
-            PacketPtr pkt = it.second.front();
-            it.second.pop_front();
-            DPRINTF(DMA, "Sending  DMA for addr: %#x size: %d\n",
-                    pkt->req->getPaddr(), pkt->req->getSize());
-            Tick lat = sendAtomic(pkt);
-
-            handleResp(pkt, lat);
-          }
+        // send everything there is to send in zero time, completing a
+        // transaction may hand its channel to a waiting one which is
+        // then drained by the same loop
+        while (!readyChannels.empty()) {
+            unsigned channel_idx = readyChannels.front();
+            readyChannels.pop_front();
+            DmaChannel &channel = channels[channel_idx];
+            channel.ready = false;
+            while (!channel.packets.empty()) {
+                PacketPtr pkt = channel.packets.front();
+                channel.packets.pop_front();
+                DPRINTF(DMA, "Sending  DMA for addr: %#x size: %d\n",
+                        pkt->req->getPaddr(), pkt->req->getSize());
+                Tick lat = sendAtomic(pkt);
+
+                // invalidations have no response, and are done once sent
+                if (pkt->isRangeInvalidate()) {
+                    pendingCount--;
+                    releaseUnanswered(pkt);
+                    continue;
+                }
+
+                handleResp(pkt, lat);
+            }
         }
     } else
         panic("Unknown memory mode.");
 }
 
+void
+DmaPort::releaseUnanswered(PacketPtr pkt)
+{
+    assert(pkt->isRequest() && !pkt->needsResponse());
+    packetPool.release(pkt);
+}
+
 Addr
 DmaPort::getPacketAddr(PacketPtr pkt) {
     DmaReqState *state = dynamic_cast<DmaReqState*>(pkt->senderState);
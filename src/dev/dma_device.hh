@@ -47,6 +47,8 @@
 #include <deque>
 #include <vector>
 
+#include "base/free_list.hh"
+#include "base/statistics.hh"
 #include "dev/io_device.hh"
 #include "params/DmaDevice.hh"
 #include "sim/drain.hh"
@@ -55,7 +57,8 @@
 //Modification of DMA for Aladdin simulation
 #define MAX_DMA_REQUEST 64
 
-/* Maximum of DMA channels*/
+/* Default and maximum number of DMA channels */
+#define DEFAULT_DMA_CHANNELS 64
 #define MAX_CHANNELS 10000
 
 class DmaPort : public MasterPort
@@ -83,9 +86,18 @@ class DmaPort : public MasterPort
         /** Is initialized by the first packet */
         bool isSent;
 
+        /** Channel this transaction is bound to, or -1 if it does not
+         * own a channel of the port. */
+        int channel;
+
+        /** True if the port allocated this state and recycles it once
+         * the transaction completes. */
+        bool ownedByPort;
+
         DmaReqState(Event *ce, Addr tb, Addr _addr, Tick _delay)
             : completionEvent(ce), totBytes(tb),
-              numBytes(0), addr(_addr), delay(_delay), isSent(false)
+              numBytes(0), addr(_addr), delay(_delay), isSent(false),
+              channel(-1), ownedByPort(false)
         {}
 
     };
@@ -128,10 +140,42 @@ class DmaPort : public MasterPort
     /** The device that owns this port. */
     MemObject *device;
 
-    /** Each deque represents a memory channel that never does any insertion or
-     * removal in the middle. A vector of deques are used to represent
-     * multi-chanel DMAs that requests across channels can be interleaved. */
-    std::vector<std::pair<DmaReqState *, std::deque<PacketPtr> > > transmitList;
+    /**
+     * A DMA channel carries the packets of one transaction. The packet
+     * deque never does any insertion or removal in the middle, and
+     * requests across channels can be interleaved in multi-channel mode.
+     */
+    struct DmaChannel
+    {
+        /** Transaction currently bound to this channel, if any. */
+        DmaReqState *state;
+
+        /** Packets of the transaction that are still to be sent. */
+        std::deque<PacketPtr> packets;
+
+        /** True if the channel is queued in readyChannels. */
+        bool ready;
+
+        /** Tick at which the current transaction was bound. */
+        Tick allocTick;
+
+        DmaChannel() : state(nullptr), ready(false), allocTick(0) {}
+    };
+
+    /** Fixed pool of channels, allocated when the port is created. */
+    std::vector<DmaChannel> channels;
+
+    /** Indices of the channels that have no transaction bound. */
+    std::vector<unsigned> freeChannels;
+
+    /** Channels that have packets to send, in service order. The
+     * front of the queue is the channel that sends next. */
+    std::deque<unsigned> readyChannels;
+
+    /** Transactions that found every channel busy, together with
+     * their packets, waiting for a channel to be recycled. */
+    std::deque<std::pair<DmaReqState *, std::deque<PacketPtr> > >
+        waitingActions;
 
     /** Event used to schedule a future sending from the transmit list. */
     EventWrapper<DmaPort, &DmaPort::sendDma> sendEvent;
@@ -159,31 +203,98 @@ class DmaPort : public MasterPort
     /** Number of outstanding requests*/
     unsigned numOutstandingRequests;
 
-    /** Keep track of the current channel index to send DMA request. */
-    int currChannelIdx;
-
     /** DMA transaction chunk size. */
     unsigned chunkSize;
 
+    /** Size of a DMA burst, or 0 if bursts are disabled. A burst
+     * carries contiguous chunks of a read or write in a single
+     * packet that the memory splits into lines itself. */
+    unsigned burstSize;
+
     /** True if we want to interleave DMA requests from different channels.*/
     bool multiChannel;
 
     /** True if we should send invalidation packets before writes.
      *
      * This would invalidate every cache line touched by a dmaAction call that
-     * updates memory before issuing the write request.
+     * updates memory before issuing the write request, using one range
+     * invalidation per call.
      */
     bool invalidateOnWrite;
+
+    /** Number of transactions served by each channel. */
+    Stats::Vector channelActions;
+
+    /** Number of ticks each channel had a transaction bound. */
+    Stats::Vector channelBusyTicks;
+
+    /** Number of transactions that waited for a free channel. */
+    Stats::Scalar channelStalls;
+
+    /** Number of burst packets sent. */
+    Stats::Scalar burstPackets;
+
+    /** Recycled storage for the requests, packets and transaction
+     * states that the port creates. */
+    FreeList<Request> requestPool;
+    FreeList<Packet> packetPool;
+    FreeList<DmaReqState> statePool;
+
+    /** Shared sender state of the invalidation packets, which never
+     * see a response and so need no state of their own. */
+    DmaReqState invalidateReqState;
+
+    /** Number of requests, packets and states taken from the heap. */
+    Stats::Value poolHeapAllocations;
+
   protected:
 
     bool recvTimingResp(PacketPtr pkt);
     void recvReqRetry() ;
 
-    void queueDma(unsigned channel_index, PacketPtr pkt);
+    /**
+     * Queue a packet of a transaction on its channel and mark the
+     * channel as ready. If the transaction is still waiting for a free
+     * channel, the packet waits with it.
+     */
+    void queueDma(DmaReqState *reqState, PacketPtr pkt);
+
+    /**
+     * Queue a single range invalidation ahead of a write, covering
+     * every cache line that the write touches.
+     */
+    void queueInvalidation(DmaReqState *reqState, Addr addr, int size,
+                           Request::Flags flag);
+
+    /**
+     * Park a transaction that found every channel busy until a channel
+     * is recycled.
+     */
+    void waitForChannel(DmaReqState *reqState);
     void switchToNextChannel();
 
+    /**
+     * Bind a transaction to a free channel.
+     *
+     * @return The channel index, or -1 if every channel is busy.
+     */
+    int allocateChannel(DmaReqState *reqState);
+
+    /**
+     * Return a channel whose transaction has completed to the pool,
+     * or hand it straight to the oldest waiting transaction.
+     */
+    void releaseChannel(unsigned channel_idx);
+
     Addr getPacketAddr(PacketPtr pkt);
 
+    /**
+     * Recycle a request packet that never gets a response, such as a
+     * range invalidation sent in atomic mode. Destroying the packet
+     * deletes its request, so the request must not come from a pool.
+     */
+    void releaseUnanswered(PacketPtr pkt);
+
     Event* getPacketCompletionEvent(PacketPtr pkt);
 
   public:
@@ -192,13 +303,31 @@ class DmaPort : public MasterPort
 
     DmaPort(MemObject *dev, System *s, unsigned max_req,
             unsigned _chunkSize, bool _multiChannel = false,
-            bool _invalidateOnWrite = false);
+            bool _invalidateOnWrite = false,
+            unsigned num_channels = DEFAULT_DMA_CHANNELS,
+            unsigned burst_size = 0);
 
     RequestPtr dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
                          uint8_t *data, Tick delay, Request::Flags flag = 0);
+    /**
+     * Queue a request of a transaction set up with addNewChannel(). The
+     * request goes to the channel the transaction is bound to, or waits
+     * with the transaction if it has none yet.
+     */
     RequestPtr dmaReqOnChannel(Packet::Command cmd, Addr addr, int size,
                                uint8_t *data, Tick delay, DmaReqState *reqState,
                                Request::Flags flag = 0, unsigned channel_idx = 0);
+
+    /** Channel index returned for a transaction waiting for a channel. */
+    static const unsigned WaitingChannel = ~0U;
+
+    /**
+     * Bind a transaction to a free channel. If every channel is busy,
+     * the transaction waits for one to be recycled, and its requests
+     * can be queued with dmaReqOnChannel() all the same.
+     *
+     * @return The channel index, or WaitingChannel.
+     */
     unsigned addNewChannel(DmaReqState *reqState);
 
     bool dmaPending() const { return pendingCount > 0; }
@@ -206,6 +335,23 @@ class DmaPort : public MasterPort
     unsigned int drain(DrainManager *drainManger);
 
     MasterID getMasterID(){return masterId;}
+
+    /** Register the channel statistics, named after the port. */
+    void regStats();
+
+    /**
+     * Fall back to line-sized packets if a cache could see the bursts,
+     * as a cache only handles, or answers a snoop for, a single line.
+     * Called once the port is connected.
+     */
+    void checkBurstPath();
+
+    /** Number of objects the pools had to take from the heap. */
+    uint64_t heapAllocations() const
+    {
+        return requestPool.heapAllocations() +
+            packetPool.heapAllocations() + statePool.heapAllocations();
+    }
 };
 
 class DmaDevice : public PioDevice
@@ -234,6 +380,8 @@ class DmaDevice : public PioDevice
 
     virtual void init();
 
+    virtual void regStats();
+
     unsigned int drain(DrainManager *drainManger);
 
     unsigned int cacheBlockSize() const { return sys->cacheLineSize(); }
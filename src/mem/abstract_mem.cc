@@ -56,6 +56,7 @@ using namespace std;
 
 AbstractMemory::AbstractMemory(const Params *p) :
     MemObject(p), range(params()->range), pmemAddr(NULL),
+    dirtyPages(NULL),
     confTableReported(p->conf_table_reported), inAddrMap(p->in_addr_map),
     _system(NULL)
 {
@@ -71,9 +72,10 @@ AbstractMemory::init()
 }
 
 void
-AbstractMemory::setBackingStore(uint8_t* pmem_addr)
+AbstractMemory::setBackingStore(uint8_t* pmem_addr, uint64_t* dirty_pages)
 {
     pmemAddr = pmem_addr;
+    dirtyPages = dirty_pages;
 }
 
 void
@@ -361,8 +363,10 @@ AbstractMemory::access(PacketPtr pkt)
                 panic("Invalid size for conditional read/write\n");
         }
 
-        if (overwrite_mem)
+        if (overwrite_mem) {
             std::memcpy(hostAddr, &overwrite_val[0], pkt->getSize());
+            markDirty(hostAddr, pkt->getSize());
+        }
 
         assert(!pkt->req->isInstFetch());
         TRACE_PACKET("Read/Write");
@@ -390,6 +394,7 @@ AbstractMemory::access(PacketPtr pkt)
         if (writeOK(pkt)) {
             if (pmemAddr) {
                 memcpy(hostAddr, pkt->getConstPtr<uint8_t>(), pkt->getSize());
+                markDirty(hostAddr, pkt->getSize());
                 DPRINTF(MemoryAccess, "%s wrote %x bytes to address %x\n",
                         __func__, pkt->getSize(), pkt->getAddr());
             }
@@ -421,8 +426,10 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
         TRACE_PACKET("Read");
         pkt->makeResponse();
     } else if (pkt->isWrite()) {
-        if (pmemAddr)
+        if (pmemAddr) {
             memcpy(hostAddr, pkt->getConstPtr<uint8_t>(), pkt->getSize());
+            markDirty(hostAddr, pkt->getSize());
+        }
         TRACE_PACKET("Write");
         pkt->makeResponse();
     } else if (pkt->isPrint()) {
@@ -110,6 +110,10 @@ class AbstractMemory : public MemObject
     // Pointer to host memory used to implement this memory
     uint8_t* pmemAddr;
 
+    // Bitmap of the pages in the backing store written since the last
+    // checkpoint, or NULL if writes are not tracked
+    uint64_t* dirtyPages;
+
     // Enable specific memories to be reported to the configuration table
     bool confTableReported;
 
@@ -124,6 +128,23 @@ class AbstractMemory : public MemObject
     // this out-of-line function
     bool checkLockedAddrList(PacketPtr pkt);
 
+    /**
+     * Mark the backing store pages covered by a write as dirty, so
+     * that an incremental checkpoint includes them.
+     *
+     * @param host_addr Host address of the first byte written
+     * @param size Number of bytes written
+     */
+    void markDirty(const uint8_t* host_addr, unsigned size)
+    {
+        if (dirtyPages == NULL || size == 0)
+            return;
+        Addr offset = host_addr - pmemAddr;
+        Addr last = (offset + size - 1) >> DirtyPageShift;
+        for (Addr page = offset >> DirtyPageShift; page <= last; ++page)
+            dirtyPages[page / 64] |= ULL(1) << (page % 64);
+    }
+
     // Record the address of a load-locked operation so that we can
     // clear the execution context's lock flag if a matching store is
     // performed
@@ -207,13 +228,18 @@ class AbstractMemory : public MemObject
      */
     bool isNull() const { return params()->null; }
 
+    /** Log2 of the granularity at which writes are tracked. */
+    static const unsigned DirtyPageShift = 12;
+
     /**
      * Set the host memory backing store to be used by this memory
      * controller.
      *
      * @param pmem_addr Pointer to a segment of host memory
+     * @param dirty_pages Dirty page bitmap of the segment, or NULL to
+     *                    not track writes
      */
-    void setBackingStore(uint8_t* pmem_addr);
+    void setBackingStore(uint8_t* pmem_addr, uint64_t* dirty_pages = NULL);
 
     /**
      * Get the list of locked addresses to allow checkpointing.
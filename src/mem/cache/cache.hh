@@ -301,6 +301,15 @@ class Cache : public BaseCache
     void handleSnoop(PacketPtr ptk, CacheBlk *blk,
                      bool is_timing, bool is_deferred, bool pending_inval);
 
+    /**
+     * Invalidate every block the range of an InvalidateRangeReq
+     * touches, in this cache and in the caches above it. Dirty data
+     * is dropped, as it is for a single line invalidation.
+     * @param pkt The range invalidation being snooped.
+     * @param is_timing Timing or atomic for the forwarded snoop.
+     */
+    void handleRangeInvalidate(PacketPtr pkt, bool is_timing);
+
     /**
      * Create a writeback request for the given block.
      * @param blk The block to writeback.
@@ -408,6 +417,9 @@ class Cache : public BaseCache
 
     void regStats();
 
+    /** Number of blocks invalidated by range invalidations. */
+    Stats::Scalar rangeInvalidatedBlocks;
+
     /** serialize the state of the caches
      * We currently don't support checkpointing cache state, so this panics.
      */
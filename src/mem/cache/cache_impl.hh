@@ -98,6 +98,11 @@ void
 Cache::regStats()
 {
     BaseCache::regStats();
+
+    rangeInvalidatedBlocks
+        .name(name() + ".range_invalidated_blocks")
+        .desc("number of blocks invalidated by range invalidations")
+        ;
 }
 
 void
@@ -1752,6 +1757,66 @@ Cache::handleSnoop(PacketPtr pkt, CacheBlk *blk, bool is_timing,
     DPRINTF(Cache, "new state is %s\n", blk->print());
 }
 
+void
+Cache::handleRangeInvalidate(PacketPtr pkt, bool is_timing)
+{
+    DPRINTF(Cache, "%s for addr %#llx size %d\n", __func__,
+            pkt->getAddr(), pkt->getSize());
+
+    if (forwardSnoops) {
+        // the caches above see the whole range in one snoop as well,
+        // no one responds to an invalidation so nothing is copied back
+        if (is_timing) {
+            Packet snoopPkt(pkt, true, false);
+            snoopPkt.setExpressSnoop();
+            snoopPkt.headerDelay = snoopPkt.payloadDelay = 0;
+            cpuSidePort->sendTimingSnoopReq(&snoopPkt);
+        } else {
+            cpuSidePort->sendAtomicSnoop(pkt);
+        }
+    }
+
+    bool is_secure = pkt->isSecure();
+    Addr end_addr = pkt->getAddr() + pkt->getSize();
+    for (Addr blk_addr = blockAlign(pkt->getAddr()); blk_addr < end_addr;
+         blk_addr += blkSize) {
+        if (!inRange(blk_addr))
+            continue;
+
+        // an outstanding miss invalidates the block once it is filled,
+        // unless we are about to own it and will supply the data
+        MSHR *mshr = mshrQueue.findMatch(blk_addr, is_secure);
+        if (mshr && !mshr->isPendingDirty()) {
+            Request line_req(blk_addr, blkSize, pkt->req->getFlags(),
+                             pkt->req->masterId());
+            Packet line_pkt(&line_req, MemCmd::InvalidationReq);
+            if (pkt->isExpressSnoop())
+                line_pkt.setExpressSnoop();
+            mshr->handleSnoop(&line_pkt, order++);
+        }
+
+        // the invalidation trumps a writeback of the block
+        std::vector<MSHR *> writebacks;
+        if (writeBuffer.findMatches(blk_addr, is_secure, writebacks)) {
+            assert(writebacks.size() == 1);
+            MSHR *wb_entry = writebacks[0];
+            PacketPtr wb_pkt = wb_entry->getTarget()->pkt;
+            assert(wb_pkt->cmd == MemCmd::Writeback);
+            markInService(wb_entry, false);
+            delete wb_pkt;
+        }
+
+        CacheBlk *blk = tags->findBlock(blk_addr, is_secure);
+        if (blk && blk->isValid()) {
+            DPRINTF(Cache, "%s invalidating blk %#llx, old state is %s\n",
+                    __func__, blk_addr, blk->print());
+            if (blk != tempBlock)
+                tags->invalidate(blk);
+            blk->invalidate();
+            rangeInvalidatedBlocks++;
+        }
+    }
+}
 
 void
 Cache::recvTimingSnoopReq(PacketPtr pkt)
@@ -1762,6 +1827,11 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
     // Snoops shouldn't happen when bypassing caches
     assert(!system->bypassCaches());
 
+    if (pkt->isRangeInvalidate()) {
+        handleRangeInvalidate(pkt, true);
+        return;
+    }
+
     // no need to snoop writebacks or requests that are not in range
     if (pkt->cmd == MemCmd::Writeback || !inRange(pkt->getAddr())) {
         return;
@@ -1853,6 +1923,11 @@ Cache::recvAtomicSnoop(PacketPtr pkt)
     // Snoops shouldn't happen when bypassing caches
     assert(!system->bypassCaches());
 
+    if (pkt->isRangeInvalidate()) {
+        handleRangeInvalidate(pkt, false);
+        return forwardLatency * clockPeriod();
+    }
+
     // no need to snoop writebacks or requests that are not in range
     if (pkt->cmd == MemCmd::Writeback || !inRange(pkt->getAddr())) {
         return 0;
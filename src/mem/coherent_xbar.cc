@@ -114,6 +114,16 @@ CoherentXBar::~CoherentXBar()
         delete p;
 }
 
+bool
+CoherentXBar::hasSnoopers() const
+{
+    // also valid before init() has gathered the snoop ports
+    for (const auto& p: slavePorts)
+        if (p->isSnooping())
+            return true;
+    return false;
+}
+
 void
 CoherentXBar::init()
 {
@@ -182,8 +192,9 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
 
     if (!system->bypassCaches()) {
         // the packet is a memory-mapped request and should be
-        // broadcasted to our snoopers but the source
-        if (snoopFilter) {
+        // broadcasted to our snoopers but the source, the snoop filter
+        // only tracks single lines so range invalidations go to all
+        if (snoopFilter && !pkt->isRangeInvalidate()) {
             // check with the snoop filter where to forward this packet
             auto sf_res = snoopFilter->lookupRequest(pkt, *src_port);
             // If SnoopFilter is enabled, the total time required by a packet
@@ -212,7 +223,7 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
     // since it is a normal request, attempt to send the packet
     bool success = masterPorts[master_port_id]->sendTimingReq(pkt);
 
-    if (snoopFilter && !system->bypassCaches()) {
+    if (snoopFilter && !system->bypassCaches() && !pkt->isRangeInvalidate()) {
         // The packet may already be overwritten by the sendTimingReq function.
         // The snoop filter needs to see the original request *and* the return
         // status of the send operation, so we need to recreate the original
@@ -579,7 +590,7 @@ CoherentXBar::recvAtomic(PacketPtr pkt, PortID slave_port_id)
     if (!system->bypassCaches()) {
         // forward to all snoopers but the source
         std::pair<MemCmd, Tick> snoop_result;
-        if (snoopFilter) {
+        if (snoopFilter && !pkt->isRangeInvalidate()) {
             // check with the snoop filter where to forward this packet
             auto sf_res =
                 snoopFilter->lookupRequest(pkt, *slavePorts[slave_port_id]);
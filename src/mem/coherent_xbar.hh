@@ -389,6 +389,9 @@ class CoherentXBar : public BaseXBar
 
     virtual ~CoherentXBar();
 
+    /** Is any master attached to the crossbar snooping? */
+    bool hasSnoopers() const;
+
     unsigned int drain(DrainManager *dm);
 
     virtual void regStats();
@@ -665,6 +665,14 @@ DRAMCtrl::recvTimingReq(PacketPtr pkt)
     unsigned offset = pkt->getAddr() & (burstSize - 1);
     unsigned int dram_pkt_count = divCeil(offset + size, burstSize);
 
+    // a packet that needs more DRAM bursts than the queue can hold
+    // would never be accepted
+    fatal_if((pkt->isRead() && dram_pkt_count > readBufferSize) ||
+             (pkt->isWrite() && dram_pkt_count > writeBufferSize),
+             "%s: request of %d bytes needs %d DRAM bursts, more than the "
+             "queue holds, reduce the DMA burst size\n", name(), size,
+             dram_pkt_count);
+
     // check local buffers and do not accept if full
     if (pkt->isRead()) {
         assert(size != 0);
@@ -121,6 +121,7 @@ class MemCmd
         PrintReq,       // Print state matching address
         FlushReq,      //request for a cache flush
         InvalidationReq,   // request for address to be invalidated from lsq
+        InvalidateRangeReq, // request for an address range to be invalidated
         NUM_MEM_CMDS
     };
 
@@ -490,6 +491,8 @@ class Packet : public Printable
     bool isError() const             { return cmd.isError(); }
     bool isPrint() const             { return cmd.isPrint(); }
     bool isFlush() const             { return cmd.isFlush(); }
+    bool isRangeInvalidate() const
+    { return cmd == MemCmd::InvalidateRangeReq; }
 
     // Snoop flags
     void assertMemInhibit()
@@ -38,6 +38,7 @@
  */
 
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <fcntl.h>
@@ -47,9 +48,13 @@
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
 
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -70,11 +75,75 @@
 
 using namespace std;
 
+/**
+ * Size of the pages a delta checkpoint is made of.
+ */
+static const uint64_t dirtyPageBytes =
+    ULL(1) << AbstractMemory::DirtyPageShift;
+
+/**
+ * Drop empty and "." components from a path, and fold ".." into the
+ * component before it where possible.
+ */
+static string
+normalizePath(const string& path)
+{
+    vector<string> parts;
+    istringstream stream(path);
+    string part;
+    while (getline(stream, part, '/')) {
+        if (part.empty() || part == ".")
+            continue;
+        if (part == ".." && !parts.empty() && parts.back() != "..")
+            parts.pop_back();
+        else
+            parts.push_back(part);
+    }
+
+    string normalized = (!path.empty() && path[0] == '/') ? "/" : "";
+    for (size_t i = 0; i < parts.size(); ++i)
+        normalized += (i ? "/" : "") + parts[i];
+    return normalized;
+}
+
+static string
+dirName(const string& path)
+{
+    size_t pos = path.rfind('/');
+    if (pos == string::npos)
+        return ".";
+    return pos == 0 ? "/" : path.substr(0, pos);
+}
+
+static string
+baseName(const string& path)
+{
+    return path.substr(path.rfind('/') + 1);
+}
+
+/**
+ * Name a memory file of an earlier checkpoint relative to the
+ * directory of the checkpoint being written if they are siblings, so
+ * that a set of checkpoints can be moved around together.
+ */
+static string
+relativeLayerPath(const string& cpt_dir, const string& layer)
+{
+    string dir = dirName(layer);
+    if (dirName(dir) == dirName(normalizePath(cpt_dir)))
+        return "../" + baseName(dir) + "/" + baseName(layer);
+    return layer;
+}
+
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
-                               bool mmap_using_noreserve) :
+                               bool mmap_using_noreserve,
+                               bool incremental_checkpoints,
+                               bool uncompressed_checkpoints) :
     _name(_name), rangeCache(addrMap.end()), size(0),
-    mmapUsingNoReserve(mmap_using_noreserve)
+    mmapUsingNoReserve(mmap_using_noreserve),
+    incrementalCheckpoints(incremental_checkpoints),
+    uncompressedCheckpoints(uncompressed_checkpoints), hostAccessed(false)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -185,12 +254,22 @@ PhysicalMemory::createBackingStore(AddrRange range,
     // remember this backing store so we can checkpoint it and unmap
     // it appropriately
     backingStore.push_back(make_pair(range, pmem));
+    storeLayers.emplace_back();
+
+    // with incremental checkpoints, track the pages that are written
+    // using one bit per page
+    dirtyPages.emplace_back();
+    if (incrementalCheckpoints)
+        dirtyPages.back().resize(divCeil(divCeil(range.size(),
+                                                 dirtyPageBytes), 64));
+    uint64_t* dirty_pages = incrementalCheckpoints ?
+        dirtyPages.back().data() : NULL;
 
     // point the memories to their backing store
     for (const auto& m : _memories) {
         DPRINTF(AddrRanges, "Mapping memory %s to backing store\n",
                 m->name());
-        m->setBackingStore(pmem);
+        m->setBackingStore(pmem, dirty_pages);
     }
 }
 
@@ -322,24 +401,69 @@ void
 PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
                                AddrRange range, uint8_t* pmem)
 {
+    vector<string>& layers = storeLayers[store_id];
+
+    // only store the dirty pages if there is an earlier checkpoint to
+    // layer them on, that checkpoint is not about to be overwritten,
+    // and the host has not been writing behind our back
+    bool delta = incrementalCheckpoints && !hostAccessed &&
+        !layers.empty() &&
+        dirName(layers.back()) != normalizePath(Checkpoint::dir());
+
+    // full images are stored uncompressed if asked to, so that a
+    // restore can map them rather than read them, the suffix telling
+    // the two layouts apart
+    bool raw = !delta && uncompressedCheckpoints;
+
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    string filename = name() + ".store" + to_string(store_id) + ".pmem";
+    string filename = name() + ".store" + to_string(store_id) +
+        (raw ? ".raw" : ".pmem");
     long range_size = range.size();
 
-    DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
-            filename, range_size);
-
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
 
+    unsigned int base_layers = delta ? layers.size() : 0;
+    SERIALIZE_SCALAR(base_layers);
+    for (unsigned int i = 0; i < base_layers; ++i)
+        paramOut(os, csprintf("base_layer%d", i),
+                 relativeLayerPath(Checkpoint::dir(), layers[i]));
+
     // write memory file
     string filepath = Checkpoint::dir() + "/" + filename.c_str();
+
+    if (delta) {
+        DPRINTF(Checkpoint, "Serializing dirty pages of physical memory "
+                "%s on top of %d earlier checkpoints\n", filename,
+                base_layers);
+        serializeDirtyPages(filepath, store_id);
+    } else {
+        DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
+                filename, range_size);
+        if (raw)
+            serializeRawImage(filepath, store_id);
+        else
+            serializeImage(filepath, store_id);
+        layers.clear();
+    }
+
+    // the next incremental checkpoint builds on this one
+    layers.push_back(normalizePath(filepath));
+    fill(dirtyPages[store_id].begin(), dirtyPages[store_id].end(), 0);
+}
+
+void
+PhysicalMemory::serializeImage(const string& filepath, unsigned int store_id)
+{
+    AddrRange range = backingStore[store_id].first;
+    uint8_t* pmem = backingStore[store_id].second;
+
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
 
     uint64_t pass_size = 0;
 
@@ -352,7 +476,7 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
         if (gzwrite(compressed_mem, pmem + written,
                     (unsigned int) pass_size) != (int) pass_size) {
             fatal("Write failed on physical memory checkpoint file '%s'\n",
-                  filename);
+                  filepath);
         }
     }
 
@@ -360,8 +484,86 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
     // is zero
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
+}
+
+void
+PhysicalMemory::serializeRawImage(const string& filepath,
+                                  unsigned int store_id)
+{
+    AddrRange range = backingStore[store_id].first;
+    uint8_t* pmem = backingStore[store_id].second;
+
+    // write to a new file and rename it into place, as the file we
+    // replace may well be mapped as our own backing store
+    string tmppath = filepath + ".tmp";
+    int fd = open(tmppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0 || ftruncate(fd, range.size()) != 0)
+        fatal("Can't create physical memory checkpoint file '%s': %s\n",
+              tmppath, strerror(errno));
+
+    // leave the pages that are all zero as holes, which keeps the
+    // file sparse and the restore from touching them
+    for (uint64_t offset = 0; offset < range.size();
+         offset += dirtyPageBytes) {
+        uint64_t page_size = min(dirtyPageBytes, range.size() - offset);
+        const uint8_t* page = pmem + offset;
+        if (page[0] == 0 && !memcmp(page, page + 1, page_size - 1))
+            continue;
+
+        for (uint64_t written = 0; written < page_size; ) {
+            ssize_t bytes = pwrite(fd, page + written, page_size - written,
+                                   offset + written);
+            if (bytes < 0 && errno != EINTR)
+                fatal("Write failed on physical memory checkpoint file "
+                      "'%s': %s\n", tmppath, strerror(errno));
+            written += max(bytes, (ssize_t)0);
+        }
+    }
+
+    if (close(fd) != 0 || rename(tmppath.c_str(), filepath.c_str()) != 0)
+        fatal("Close failed on physical memory checkpoint file '%s': %s\n",
+              filepath, strerror(errno));
+}
+
+void
+PhysicalMemory::serializeDirtyPages(const string& filepath,
+                                    unsigned int store_id)
+{
+    AddrRange range = backingStore[store_id].first;
+    uint8_t* pmem = backingStore[store_id].second;
+    const vector<uint64_t>& dirty = dirtyPages[store_id];
+
+    // deltas are written often, so favour speed over compression
+    gzFile compressed_mem = gzopen(filepath.c_str(), "wb1");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    uint64_t pages = 0;
+    for (uint64_t word = 0; word < dirty.size(); ++word) {
+        for (uint64_t bits = dirty[word]; bits != 0; bits &= bits - 1) {
+            uint64_t page = word * 64 + findLsbSet(bits);
+            uint64_t offset = page * dirtyPageBytes;
+            unsigned int page_size =
+                min(dirtyPageBytes, range.size() - offset);
+
+            if (gzwrite(compressed_mem, &page, sizeof(page)) !=
+                (int) sizeof(page) ||
+                gzwrite(compressed_mem, pmem + offset, page_size) !=
+                (int) page_size) {
+                fatal("Write failed on physical memory checkpoint file "
+                      "'%s'\n", filepath);
+            }
+            ++pages;
+        }
+    }
+
+    if (gzclose(compressed_mem))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
 
+    DPRINTF(Checkpoint, "Wrote %d dirty pages to %s\n", pages, filepath);
 }
 
 void
@@ -391,8 +593,6 @@ PhysicalMemory::unserialize(Checkpoint* cp, const string& section)
 void
 PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -400,13 +600,7 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp->cptDir + "/" + filename;
 
-    // mmap memoryfile
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-    if (compressed_mem == NULL)
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
-
     // we've already got the actual backing store mapped
-    uint8_t* pmem = backingStore[store_id].second;
     AddrRange range = backingStore[store_id].first;
 
     long range_size;
@@ -419,6 +613,57 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    // an incremental checkpoint only holds the pages written since
+    // the checkpoints it names as its base, full image first
+    unsigned int base_layers = 0;
+    string value;
+    if (cp->find(section, "base_layers", value))
+        UNSERIALIZE_SCALAR(base_layers);
+
+    vector<string>& layers = storeLayers[store_id];
+    layers.clear();
+    for (unsigned int i = 0; i < base_layers; ++i) {
+        string layer;
+        paramIn(cp, section, csprintf("base_layer%d", i), layer);
+        if (layer.empty() || layer[0] != '/')
+            layer = cp->cptDir + "/" + layer;
+        layers.push_back(normalizePath(layer));
+    }
+    layers.push_back(normalizePath(filepath));
+
+    unserializeImage(layers.front(), store_id);
+    for (size_t i = 1; i < layers.size(); ++i) {
+        DPRINTF(Checkpoint, "Layering physical memory delta %s\n",
+                layers[i]);
+        unserializeDirtyPages(layers[i], store_id);
+    }
+
+    // the next incremental checkpoint builds on this one
+    fill(dirtyPages[store_id].begin(), dirtyPages[store_id].end(), 0);
+}
+
+void
+PhysicalMemory::unserializeImage(const string& filepath,
+                                 unsigned int store_id)
+{
+    const string raw_suffix = ".raw";
+    if (filepath.size() > raw_suffix.size() &&
+        filepath.compare(filepath.size() - raw_suffix.size(),
+                         raw_suffix.size(), raw_suffix) == 0) {
+        mapRawImage(filepath, store_id);
+        return;
+    }
+
+    const uint32_t chunk_size = 16384;
+
+    // mmap memoryfile
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filepath);
+
+    uint8_t* pmem = backingStore[store_id].second;
+    AddrRange range = backingStore[store_id].first;
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
@@ -445,5 +690,72 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
 
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
+}
+
+void
+PhysicalMemory::mapRawImage(const string& filepath, unsigned int store_id)
+{
+    AddrRange range = backingStore[store_id].first;
+    uint8_t* pmem = backingStore[store_id].second;
+
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        fatal("Can't open physical memory checkpoint file '%s'\n", filepath);
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+        (uint64_t)file_stat.st_size != range.size())
+        fatal("Physical memory checkpoint file '%s' does not match the size "
+              "of range %s\n", filepath, range.to_string());
+
+    // replace the anonymous backing store with a private mapping of
+    // the image at the same address, so that the memories need not
+    // be told, pages are only read from the file as they are touched,
+    // and writes stay local to this simulation
+    int map_flags = MAP_PRIVATE | MAP_FIXED;
+    if (mmapUsingNoReserve)
+        map_flags |= MAP_NORESERVE;
+
+    DPRINTF(Checkpoint, "Mapping physical memory image %s\n", filepath);
+    if (mmap(pmem, range.size(), PROT_READ | PROT_WRITE, map_flags,
+             fd, 0) == MAP_FAILED) {
+        perror("mmap");
+        fatal("Could not mmap physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+
+    close(fd);
+}
+
+void
+PhysicalMemory::unserializeDirtyPages(const string& filepath,
+                                      unsigned int store_id)
+{
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filepath);
+
+    uint8_t* pmem = backingStore[store_id].second;
+    AddrRange range = backingStore[store_id].first;
+
+    uint64_t page;
+    int bytes_read;
+    while ((bytes_read = gzread(compressed_mem, &page, sizeof(page))) > 0) {
+        uint64_t offset = page * dirtyPageBytes;
+        if (bytes_read != (int) sizeof(page) || offset >= range.size())
+            fatal("Corrupt physical memory checkpoint file '%s'\n",
+                  filepath);
+
+        // the whole page is stored, so copy it as is, zeroes included
+        unsigned int page_size = min(dirtyPageBytes, range.size() - offset);
+        if (gzread(compressed_mem, pmem + offset, page_size) !=
+            (int) page_size)
+            fatal("Corrupt physical memory checkpoint file '%s'\n",
+                  filepath);
+    }
+
+    if (bytes_read < 0 || gzclose(compressed_mem))
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filepath);
 }
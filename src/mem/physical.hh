@@ -92,6 +92,26 @@ class PhysicalMemory : public Serializable
     // system
     std::vector<std::pair<AddrRange, uint8_t*>> backingStore;
 
+    // Only checkpoint the pages written since the previous checkpoint
+    const bool incrementalCheckpoints;
+
+    // Store full memory images uncompressed, so they can be mapped
+    const bool uncompressedCheckpoints;
+
+    // Per backing store bitmap of the pages written since the last
+    // checkpoint was taken or restored, empty unless checkpoints are
+    // incremental
+    std::vector<std::vector<uint64_t>> dirtyPages;
+
+    // Per backing store memory files that make up the last checkpoint
+    // taken or restored, a full image followed by the deltas to layer
+    // on top of it, or empty if there is nothing to build on
+    std::vector<std::vector<std::string>> storeLayers;
+
+    // Set once the backing store is handed out for host access, as
+    // such writes bypass the dirty tracking
+    mutable bool hostAccessed;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -109,6 +129,47 @@ class PhysicalMemory : public Serializable
     void createBackingStore(AddrRange range,
                             const std::vector<AbstractMemory*>& _memories);
 
+    /**
+     * Write a backing store to a compressed memory file.
+     */
+    void serializeImage(const std::string& filepath, unsigned int store_id);
+
+    /**
+     * Write a backing store to an uncompressed, sparse memory file
+     * that a restore can map directly.
+     */
+    void serializeRawImage(const std::string& filepath,
+                           unsigned int store_id);
+
+    /**
+     * Write the pages of a backing store that are marked dirty to a
+     * memory file, as a sequence of page index and page contents.
+     *
+     * @param filepath The memory file to write
+     * @param store_id The backing store to write
+     */
+    void serializeDirtyPages(const std::string& filepath,
+                                 unsigned int store_id);
+
+    /**
+     * Read a full memory image into a backing store, or map it if it
+     * is uncompressed.
+     */
+    void unserializeImage(const std::string& filepath, unsigned int store_id);
+
+    /**
+     * Map an uncompressed memory image copy-on-write in place of the
+     * backing store, so that it is paged in lazily as it is used.
+     */
+    void mapRawImage(const std::string& filepath, unsigned int store_id);
+
+    /**
+     * Read a delta written by serializeDirtyPages and apply it on top
+     * of the current contents of a backing store.
+     */
+    void unserializeDirtyPages(const std::string& filepath,
+                               unsigned int store_id);
+
   public:
 
     /**
@@ -116,7 +177,9 @@ class PhysicalMemory : public Serializable
      */
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
-                   bool mmap_using_noreserve);
+                   bool mmap_using_noreserve,
+                   bool incremental_checkpoints = false,
+                   bool uncompressed_checkpoints = false);
 
     /**
      * Unmap all the backing store we have used.
@@ -163,12 +226,13 @@ class PhysicalMemory : public Serializable
      * that memories that are null are not present, and that the
      * backing store may also contain memories that are not part of
      * the OS-visible global address map and thus are allowed to
-     * overlap.
+     * overlap. As host writes are not tracked, any checkpoint taken
+     * after this call stores full memory images.
      *
      * @return Pointers to the memory backing store
      */
     std::vector<std::pair<AddrRange, uint8_t*>> getBackingStore() const
-    { return backingStore; }
+    { hostAccessed = true; return backingStore; }
 
     /**
      * Perform an untimed memory access and update all the state
@@ -200,7 +264,10 @@ class PhysicalMemory : public Serializable
     void serialize(std::ostream& os);
 
     /**
-     * Serialize a specific store.
+     * Serialize a specific store. With incremental checkpoints, only
+     * the pages written since the previous checkpoint are stored, and
+     * the memory files of that checkpoint are referenced as the base
+     * to layer them on.
      *
      * @param store_id Unique identifier of this backing store
      * @param range The address range of this backing store
@@ -217,7 +284,8 @@ class PhysicalMemory : public Serializable
     void unserialize(Checkpoint* cp, const std::string& section);
 
     /**
-     * Unserialize a specific backing store, identified by a section.
+     * Unserialize a specific backing store, identified by a section,
+     * restoring the base image and layering any deltas on top of it.
      */
     void unserializeStore(Checkpoint* cp, const std::string& section);
 
@@ -165,6 +165,10 @@ class Request
     /** The request is a ACC-Task data */
     static const FlagsType ACC_TASK_DATA               = 0x40000000;
 
+    /** The request is a DMA burst that covers several contiguous cache
+     * lines, which the memory transfers back to back. */
+    static const FlagsType DMA_BURST                   = 0x80000000;
+
     /** These flags are *not* cleared when a Request object is reused
        (assigned a new address). */
     static const FlagsType STICKY_FLAGS = INST_FETCH;
@@ -649,6 +653,7 @@ class Request
     bool isClearLL() const { return _flags.isSet(CLEAR_LL); }
     bool isSecure() const { return _flags.isSet(SECURE); }
     bool isPTWalk() const { return _flags.isSet(PT_WALK); }
+    bool isDmaBurst() const { return _flags.isSet(DMA_BURST); }
 };
 
 #endif // __MEM_REQUEST_HH__
@@ -87,6 +87,14 @@ class Consumer
 
           void process() { m_consumer_ptr->wakeup(); }
 
+          const std::string
+          name() const
+          {
+              return m_consumer_ptr->em->name() + ".consumer_event";
+          }
+
+          const char *description() const { return "Ruby consumer wakeup"; }
+
       private:
           Consumer* m_consumer_ptr;
     };
@@ -26,22 +26,42 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <utility>
+
 #include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/system/System.hh"
 
 DataBlock::DataBlock(const DataBlock &cp)
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
+    alloc();
     memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
-    m_alloc = true;
+}
+
+DataBlock::DataBlock(DataBlock &&cp)
+{
+    if (cp.m_alloc) {
+        // take over the heap buffer, leaving cp only fit to be
+        // assigned to or destroyed
+        m_data = cp.m_data;
+        m_alloc = true;
+        cp.m_data = NULL;
+        cp.m_alloc = false;
+    } else {
+        alloc();
+        memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+    }
 }
 
 void
 DataBlock::alloc()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    m_alloc = true;
-    clear();
+    if (RubySystem::getBlockSizeBytes() <= InlineBytes) {
+        m_data = m_inline;
+        m_alloc = false;
+    } else {
+        m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
+        m_alloc = true;
+    }
 }
 
 void
@@ -87,6 +107,21 @@ DataBlock::setData(const uint8_t *data, int offset, int len)
 DataBlock &
 DataBlock::operator=(const DataBlock & obj)
 {
+    if (m_data == NULL)
+        alloc();
     memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
     return *this;
 }
+
+DataBlock &
+DataBlock::operator=(DataBlock && obj)
+{
+    if (m_alloc && obj.m_alloc) {
+        std::swap(m_data, obj.m_data);
+    } else if (this != &obj) {
+        if (m_data == NULL)
+            alloc();
+        memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    }
+    return *this;
+}
@@ -38,12 +38,21 @@
 class DataBlock
 {
   public:
+    /**
+     * Number of bytes stored inline in every block, which covers the
+     * default block size. Blocks of systems with larger blocks fall
+     * back to allocating their data on the heap.
+     */
+    static const unsigned InlineBytes = 64;
+
     DataBlock()
     {
         alloc();
+        clear();
     }
 
     DataBlock(const DataBlock &cp);
+    DataBlock(DataBlock &&cp);
 
     ~DataBlock()
     {
@@ -52,6 +61,7 @@ class DataBlock
     }
 
     DataBlock& operator=(const DataBlock& obj);
+    DataBlock& operator=(DataBlock&& obj);
 
     void assign(uint8_t *data);
 
@@ -65,9 +75,12 @@ class DataBlock
     void print(std::ostream& out) const;
 
   private:
+    // point m_data at storage for a block, without clearing it
     void alloc();
+
     uint8_t *m_data;
     bool m_alloc;
+    uint8_t m_inline[InlineBytes];
 };
 
 inline void
@@ -28,26 +28,15 @@
 
 #include <algorithm>
 
+#include "base/bitfield.hh"
+#include "base/misc.hh"
 #include "mem/ruby/common/NetDest.hh"
 
-NetDest::NetDest()
-{
-  resize();
-}
-
-void
-NetDest::add(MachineID newElement)
-{
-    assert(bitIndex(newElement.num) < m_bits[vecIndex(newElement)].getSize());
-    m_bits[vecIndex(newElement)].add(bitIndex(newElement.num));
-}
-
 void
 NetDest::addNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].addSet(netDest.m_bits[i]);
+    for (int i = 0; i < NumWords; i++) {
+        m_bits[i] |= netDest.m_bits[i];
     }
 }
 
@@ -57,29 +46,39 @@ NetDest::setNetDest(MachineType machine, const Set& set)
     // assure that there is only one set of destinations for this machine
     assert(MachineType_base_level((MachineType)(machine + 1)) -
            MachineType_base_level(machine) == 1);
-    m_bits[MachineType_base_level(machine)] = set;
+    int base = MachineType_base_number(machine);
+    int size = MachineType_base_count(machine);
+    for (NodeID i = 0; i < size; i++) {
+        MachineID mach = {machine, i};
+        remove(mach);
+    }
+    for (NodeID i = 0; i < set.getSize(); i++) {
+        if (set.isElement(i))
+            addIndex(base + i);
+    }
 }
 
 void
 NetDest::remove(MachineID oldElement)
 {
-    m_bits[vecIndex(oldElement)].remove(bitIndex(oldElement.num));
+    int i = index(oldElement);
+    assert(i >= 0 && i < MaxMachines);
+    m_bits[i / WordBits] &= ~(uint64_t(1) << (i % WordBits));
 }
 
 void
 NetDest::removeNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].removeSet(netDest.m_bits[i]);
+    for (int i = 0; i < NumWords; i++) {
+        m_bits[i] &= ~netDest.m_bits[i];
     }
 }
 
 void
 NetDest::clear()
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].clear();
+    for (int i = 0; i < NumWords; i++) {
+        m_bits[i] = 0;
     }
 }
 
@@ -106,14 +105,8 @@ std::vector<NodeID>
 NetDest::getAllDest()
 {
     std::vector<NodeID> dest;
-    dest.clear();
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                int id = MachineType_base_number((MachineType)i) + j;
-                dest.push_back((NodeID)id);
-            }
-        }
+    for (int i = nextIndex(0); i != -1; i = nextIndex(i + 1)) {
+        dest.push_back((NodeID)i);
     }
     return dest;
 }
@@ -122,28 +115,40 @@ int
 NetDest::count() const
 {
     int counter = 0;
-    for (int i = 0; i < m_bits.size(); i++) {
-        counter += m_bits[i].count();
+    for (int i = 0; i < NumWords; i++) {
+        counter += popCount(m_bits[i]);
     }
     return counter;
 }
 
-NodeID
-NetDest::elementAt(MachineID index)
+int
+NetDest::nextIndex(int index) const
 {
-    return m_bits[vecIndex(index)].elementAt(bitIndex(index.num));
+    int i = index / WordBits;
+    if (i >= NumWords)
+        return -1;
+
+    // drop the bits below index from its word
+    uint64_t word = m_bits[i] & (~uint64_t(0) << (index % WordBits));
+    while (word == 0) {
+        if (++i == NumWords)
+            return -1;
+        word = m_bits[i];
+    }
+    return i * WordBits + findLsbSet(word);
 }
 
 MachineID
 NetDest::smallestElement() const
 {
     assert(count() > 0);
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (NodeID j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                MachineID mach = {MachineType_from_base_level(i), j};
-                return mach;
-            }
+    int index = nextIndex(0);
+    for (MachineType machine = MachineType_FIRST;
+         machine < MachineType_NUM; ++machine) {
+        int base = MachineType_base_number(machine);
+        if (index < base + MachineType_base_count(machine)) {
+            MachineID mach = {machine, (NodeID)(index - base)};
+            return mach;
         }
     }
     panic("No smallest element of an empty set.");
@@ -152,10 +157,10 @@ NetDest::smallestElement() const
 MachineID
 NetDest::smallestElement(MachineType machine) const
 {
-    int size = m_bits[MachineType_base_level(machine)].getSize();
+    int size = MachineType_base_count(machine);
     for (NodeID j = 0; j < size; j++) {
-        if (m_bits[MachineType_base_level(machine)].isElement(j)) {
-            MachineID mach = {machine, j};
+        MachineID mach = {machine, j};
+        if (isElement(mach)) {
             return mach;
         }
     }
@@ -167,8 +172,12 @@ NetDest::smallestElement(MachineType machine) const
 bool
 NetDest::isBroadcast() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isBroadcast()) {
+    int machines = MachineType_base_number(MachineType_NUM);
+    for (int i = 0; i < NumWords; i++) {
+        int bits = std::min(std::max(machines - i * WordBits, 0), WordBits);
+        uint64_t mask = bits == WordBits ?
+            ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        if ((m_bits[i] & mask) != mask) {
             return false;
         }
     }
@@ -179,22 +188,20 @@ NetDest::isBroadcast() const
 bool
 NetDest::isEmpty() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isEmpty()) {
-            return false;
-        }
+    uint64_t any = 0;
+    for (int i = 0; i < NumWords; i++) {
+        any |= m_bits[i];
     }
-    return true;
+    return any == 0;
 }
 
 // returns the logical OR of "this" set and orNetDest
 NetDest
 NetDest::OR(const NetDest& orNetDest) const
 {
-    assert(m_bits.size() == orNetDest.getSize());
     NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].OR(orNetDest.m_bits[i]);
+    for (int i = 0; i < NumWords; i++) {
+        result.m_bits[i] = m_bits[i] | orNetDest.m_bits[i];
     }
     return result;
 }
@@ -203,10 +210,9 @@ NetDest::OR(const NetDest& orNetDest) const
 NetDest
 NetDest::AND(const NetDest& andNetDest) const
 {
-    assert(m_bits.size() == andNetDest.getSize());
     NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].AND(andNetDest.m_bits[i]);
+    for (int i = 0; i < NumWords; i++) {
+        result.m_bits[i] = m_bits[i] & andNetDest.m_bits[i];
     }
     return result;
 }
@@ -215,53 +221,41 @@ NetDest::AND(const NetDest& andNetDest) const
 bool
 NetDest::intersectionIsNotEmpty(const NetDest& other_netDest) const
 {
-    assert(m_bits.size() == other_netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].intersectionIsEmpty(other_netDest.m_bits[i])) {
-            return true;
-        }
+    uint64_t any = 0;
+    for (int i = 0; i < NumWords; i++) {
+        any |= m_bits[i] & other_netDest.m_bits[i];
     }
-    return false;
+    return any != 0;
 }
 
 bool
 NetDest::isSuperset(const NetDest& test) const
 {
-    assert(m_bits.size() == test.getSize());
-
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isSuperset(test.m_bits[i])) {
-            return false;
-        }
+    uint64_t missing = 0;
+    for (int i = 0; i < NumWords; i++) {
+        missing |= test.m_bits[i] & ~m_bits[i];
     }
-    return true;
+    return missing == 0;
 }
 
 bool
 NetDest::isElement(MachineID element) const
 {
-    return ((m_bits[vecIndex(element)])).isElement(bitIndex(element.num));
-}
-
-void
-NetDest::resize()
-{
-    m_bits.resize(MachineType_base_level(MachineType_NUM));
-    assert(m_bits.size() == MachineType_NUM);
-
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].setSize(MachineType_base_count((MachineType)i));
-    }
+    int i = index(element);
+    assert(i >= 0 && i < MaxMachines);
+    return (m_bits[i / WordBits] >> (i % WordBits)) & 1;
 }
 
 void
 NetDest::print(std::ostream& out) const
 {
-    out << "[NetDest (" << m_bits.size() << ") ";
+    out << "[NetDest (" << MachineType_NUM << ") ";
 
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            out << (bool) m_bits[i].isElement(j) << " ";
+    for (MachineType machine = MachineType_FIRST;
+         machine < MachineType_NUM; ++machine) {
+        for (NodeID j = 0; j < MachineType_base_count(machine); j++) {
+            MachineID mach = {machine, j};
+            out << isElement(mach) << " ";
         }
         out << " - ";
     }
@@ -271,10 +265,9 @@ NetDest::print(std::ostream& out) const
 bool
 NetDest::isEqual(const NetDest& n) const
 {
-    assert(m_bits.size() == n.m_bits.size());
-    for (unsigned int i = 0; i < m_bits.size(); ++i) {
-        if (!m_bits[i].isEqual(n.m_bits[i]))
-            return false;
+    uint64_t diff = 0;
+    for (int i = 0; i < NumWords; i++) {
+        diff |= m_bits[i] ^ n.m_bits[i];
     }
-    return true;
+    return diff == 0;
 }
@@ -30,30 +30,41 @@
 // This is backward compatible with the Set class that was previously
 // used to specify network destinations.
 // NetDest supports both node networks and component networks
+//
+// The destinations are held in a fixed number of 64-bit words, one bit
+// per machine at index MachineType_base_number(type) + num, so that
+// copies do not allocate and set operations are a handful of word
+// operations the compiler can vectorize. The number of bits is set at
+// build time with MAX_RUBY_MACHINES.
 
 #ifndef __MEM_RUBY_COMMON_NETDEST_HH__
 #define __MEM_RUBY_COMMON_NETDEST_HH__
 
+#include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
+#include "config/max_ruby_machines.hh"
 #include "mem/ruby/common/Set.hh"
 #include "mem/ruby/common/MachineID.hh"
 
 class NetDest
 {
   public:
+    //! Most machines, of all types together, a NetDest can hold.
+    static const int MaxMachines = MAX_RUBY_MACHINES;
+
     // Constructors
     // creates and empty set
-    NetDest();
-    explicit NetDest(int bit_size);
+    NetDest() { clear(); }
 
     NetDest& operator=(const Set& obj);
 
     ~NetDest()
     { }
 
-    void add(MachineID newElement);
+    void add(MachineID newElement) { addIndex(index(newElement)); }
     void addNetDest(const NetDest& netDest);
     void setNetDest(MachineType machine, const Set& set);
     void remove(MachineID oldElement);
@@ -74,7 +85,11 @@ class NetDest
     bool intersectionIsNotEmpty(const NetDest& other_netDest) const;
 
     // Returns true if the intersection of the two netDests is empty
-    bool intersectionIsEmpty(const NetDest& other_netDest) const;
+    bool
+    intersectionIsEmpty(const NetDest& other_netDest) const
+    {
+        return !intersectionIsNotEmpty(other_netDest);
+    }
 
     bool isSuperset(const NetDest& test) const;
     bool isSubset(const NetDest& test) const { return test.isSuperset(*this); }
@@ -88,28 +103,33 @@ class NetDest
     MachineID smallestElement() const;
     MachineID smallestElement(MachineType machine) const;
 
-    void resize();
-    int getSize() const { return m_bits.size(); }
-
     // get element for a index
-    NodeID elementAt(MachineID index);
+    NodeID elementAt(MachineID index) { return isElement(index); }
+
+    // Elements by their index, MachineType_base_number(type) + num
+    void
+    addIndex(int index)
+    {
+        assert(index >= 0 && index < MaxMachines);
+        m_bits[index / WordBits] |= uint64_t(1) << (index % WordBits);
+    }
+
+    // Index of the first element at or after index, or -1 if none
+    int nextIndex(int index) const;
 
     void print(std::ostream& out) const;
 
   private:
-    // returns a value >= MachineType_base_level("this machine")
-    // and < MachineType_base_level("next highest machine")
-    int
-    vecIndex(MachineID m) const
+    static const int WordBits = 64;
+    static const int NumWords = (MaxMachines + WordBits - 1) / WordBits;
+
+    static int
+    index(MachineID m)
     {
-        int vec_index = MachineType_base_level(m.type);
-        assert(vec_index < m_bits.size());
-        return vec_index;
+        return MachineType_base_number(m.type) + m.num;
     }
 
-    NodeID bitIndex(NodeID index) const { return index; }
-
-    std::vector<Set> m_bits;  // a vector of bit vectors - i.e. Sets
+    uint64_t m_bits[NumWords];
 };
 
 inline std::ostream&
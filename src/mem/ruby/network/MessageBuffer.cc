@@ -26,6 +26,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <cassert>
 
 #include "base/cprintf.hh"
@@ -64,12 +65,26 @@ MessageBuffer::MessageBuffer(const string &name)
     m_vnet_id = 0;
 }
 
+MessageBuffer::~MessageBuffer()
+{
+    // Hand the stalled nodes back before the queue frees its pool.
+    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
+         map_iter != m_stall_msg_map.end(); ++map_iter) {
+        MessageBufferNode* node = map_iter->second.m_head;
+        while (node != NULL) {
+            MessageBufferNode* next = node->m_next;
+            m_prio_queue.releaseNode(node);
+            node = next;
+        }
+    }
+}
+
 unsigned int
 MessageBuffer::getSize()
 {
     if (m_time_last_time_size_checked != m_receiver->curCycle()) {
         m_time_last_time_size_checked = m_receiver->curCycle();
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = m_prio_queue.size();
     }
 
     return m_size_last_time_size_checked;
@@ -91,8 +106,8 @@ MessageBuffer::areNSlotsAvailable(unsigned int n)
     unsigned int current_size = 0;
 
     if (m_time_last_time_pop < m_sender->clockEdge()) {
-        // no pops this cycle - heap size is correct
-        current_size = m_prio_heap.size();
+        // no pops this cycle - queue size is correct
+        current_size = m_prio_queue.size();
     } else {
         if (m_time_last_time_enqueue < m_sender->curCycle()) {
             // no enqueues this cycle - m_size_at_cycle_start is correct
@@ -108,9 +123,9 @@ MessageBuffer::areNSlotsAvailable(unsigned int n)
     if (current_size + n <= m_max_size) {
         return true;
     } else {
-        DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
+        DPRINTF(RubyQueue, "n: %d, current_size: %d, queue size: %d, "
                 "m_max_size: %d\n",
-                n, current_size, m_prio_heap.size(), m_max_size);
+                n, current_size, m_prio_queue.size(), m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -122,7 +137,7 @@ MessageBuffer::peek() const
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
     assert(isReady());
 
-    const Message* msg_ptr = m_prio_heap.front().m_msgptr.get();
+    const Message* msg_ptr = m_prio_queue.front().m_msgptr.get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
@@ -152,7 +167,6 @@ MessageBuffer::enqueue(MsgPtr message, Cycles delta)
         m_time_last_time_enqueue = m_sender->curCycle();
     }
 
-    m_msg_counter++;
     m_msgs_this_cycle++;
 
     // Calculate the arrival time of the message, that is, the first
@@ -205,11 +219,32 @@ MessageBuffer::enqueue(MsgPtr message, Cycles delta)
     msg_ptr->updateDelayedTicks(m_sender->clockEdge());
     msg_ptr->setLastEnqueueTime(arrival_time);
 
-    // Insert the message into the priority heap
-    MessageBufferNode thisNode(arrival_time, m_msg_counter, message);
-    m_prio_heap.push_back(thisNode);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-        greater<MessageBufferNode>());
+    if (crossesEventQueues()) {
+        // The receiver may be running on another thread. Hand the
+        // message over and have the receiver's queue put it in the buffer
+        // when it arrives, which must be no earlier than the next
+        // synchronization of the two queues.
+        fatal_if(m_max_size != 0, "%s: finite buffers can't connect "
+                 "objects on different event queues\n", m_name);
+        fatal_if(arrival_time < curTick() + simQuantum, "%s: message "
+                 "crosses event queues in %d ticks, less than the %d tick "
+                 "quantum\n", m_name, arrival_time - curTick(), simQuantum);
+
+        DPRINTF(RubyQueue, "Enqueue for another event queue, "
+                "arrival_time: %lld, Message: %s\n",
+                arrival_time, *(message.get()));
+
+        {
+            std::lock_guard<std::mutex> lock(m_incoming_mutex);
+            m_incoming.push_back(MessageBufferNode(arrival_time, 0, message));
+        }
+        m_receiver->schedule(new ArrivalEvent(this), arrival_time);
+        return;
+    }
+
+    // Insert the message into the priority queue
+    m_msg_counter++;
+    m_prio_queue.push(arrival_time, m_msg_counter, message);
 
     DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
             arrival_time, *(message.get()));
@@ -220,38 +255,93 @@ MessageBuffer::enqueue(MsgPtr message, Cycles delta)
     m_consumer->storeEventInfo(m_vnet_id);
 }
 
-Cycles
-MessageBuffer::dequeue()
+void
+MessageBuffer::moveIncoming()
+{
+    std::lock_guard<std::mutex> lock(m_incoming_mutex);
+
+    // Only strictly ordered buffers are sent messages in order of
+    // arrival, so check all of them rather than just a prefix.
+    vector<MessageBufferNode>::iterator kept = m_incoming.begin();
+    for (vector<MessageBufferNode>::iterator it = m_incoming.begin();
+         it != m_incoming.end(); ++it) {
+        if (it->m_time > curTick()) {
+            *kept++ = *it;
+            continue;
+        }
+
+        DPRINTF(RubyQueue, "Arrived from another event queue: %s\n",
+                *(it->m_msgptr.get()));
+
+        m_msg_counter++;
+        m_prio_queue.push(it->m_time, m_msg_counter, it->m_msgptr);
+    }
+    m_incoming.erase(kept, m_incoming.end());
+
+    assert(m_consumer != NULL);
+    m_consumer->scheduleEventAbsolute(curTick());
+    m_consumer->storeEventInfo(m_vnet_id);
+}
+
+void
+MessageBuffer::delayHead()
+{
+    MessageBufferNode* node = m_prio_queue.popNode();
+
+    if (crossesEventQueues()) {
+        // enqueue() runs on the sender's clock and thread, so requeue
+        // the message on the receiver's side instead.
+        StallList delayed;
+        delayed.m_head = delayed.m_tail = node;
+        reanalyzeList(delayed, m_receiver->clockEdge(Cycles(1)));
+    } else {
+        MsgPtr message = node->m_msgptr;
+        m_prio_queue.releaseNode(node);
+        enqueue(message, Cycles(1));
+    }
+}
+
+MessageBufferNode*
+MessageBuffer::dequeueNode()
 {
     DPRINTF(RubyQueue, "Popping\n");
     assert(isReady());
 
-    // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front().m_msgptr;
-
-    // get the delay cycles
-    message->updateDelayedTicks(m_receiver->clockEdge());
-    Cycles delayCycles =
-        m_receiver->ticksToCycles(message->getDelayedTicks());
+    // update the delay cycles of the message about to be dequeued
+    m_prio_queue.front().m_msgptr->
+        updateDelayedTicks(m_receiver->clockEdge());
 
     // record previous size and time so the current buffer size isn't
     // adjusted until next cycle
     if (m_time_last_time_pop < m_receiver->clockEdge()) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = m_prio_queue.size();
         m_time_last_time_pop = m_receiver->clockEdge();
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-        greater<MessageBufferNode>());
-    m_prio_heap.pop_back();
+    return m_prio_queue.popNode();
+}
 
+Cycles
+MessageBuffer::dequeue()
+{
+    MessageBufferNode* node = dequeueNode();
+
+    // get the delay cycles
+    Cycles delayCycles =
+        m_receiver->ticksToCycles(node->m_msgptr->getDelayedTicks());
+
+    m_prio_queue.releaseNode(node);
     return delayCycles;
 }
 
 void
 MessageBuffer::clear()
 {
-    m_prio_heap.clear();
+    m_prio_queue.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_incoming_mutex);
+        m_incoming.clear();
+    }
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = Cycles(0);
@@ -265,32 +355,30 @@ MessageBuffer::recycle()
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady());
-    MessageBufferNode node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-        greater<MessageBufferNode>());
-
-    node.m_time = m_receiver->clockEdge(m_recycle_latency);
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-        greater<MessageBufferNode>());
+    MessageBufferNode* node = m_prio_queue.popNode();
+
+    // the message keeps its counter, as it did on the heap
+    node->m_time = m_receiver->clockEdge(m_recycle_latency);
+    m_prio_queue.pushNode(node);
     m_consumer->
         scheduleEventAbsolute(m_receiver->clockEdge(m_recycle_latency));
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick nextTick)
+MessageBuffer::reanalyzeList(StallList &lt, Tick nextTick)
 {
-    while(!lt.empty()) {
-        m_msg_counter++;
-        MessageBufferNode msgNode(nextTick, m_msg_counter, lt.front());
+    while (lt.m_head != NULL) {
+        MessageBufferNode* node = lt.m_head;
+        lt.m_head = node->m_next;
 
-        m_prio_heap.push_back(msgNode);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MessageBufferNode>());
+        m_msg_counter++;
+        node->m_time = nextTick;
+        node->m_msg_counter = m_msg_counter;
+        m_prio_queue.pushNode(node);
 
         m_consumer->scheduleEventAbsolute(nextTick);
-        lt.pop_front();
     }
+    lt.m_tail = NULL;
 }
 
 void
@@ -302,10 +390,11 @@ MessageBuffer::reanalyzeMessages(const Address& addr)
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap
+    // prio queue
     //
-    reanalyzeList(m_stall_msg_map[addr], nextTick);
-    m_stall_msg_map.erase(addr);
+    StallMsgMapType::iterator map_iter = m_stall_msg_map.find(addr);
+    reanalyzeList(map_iter->second, nextTick);
+    m_stall_msg_map.erase(map_iter);
 }
 
 void
@@ -315,12 +404,20 @@ MessageBuffer::reanalyzeAllMessages()
     Tick nextTick = m_receiver->clockEdge(Cycles(1));
 
     //
-    // Put all stalled messages associated with this address back on the
-    // prio heap
+    // Put all stalled messages back on the prio queue, in order of
+    // their addresses
     //
+    vector<Address> addrs;
+    addrs.reserve(m_stall_msg_map.size());
     for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
          map_iter != m_stall_msg_map.end(); ++map_iter) {
-        reanalyzeList(map_iter->second, nextTick);
+        addrs.push_back(map_iter->first);
+    }
+    sort(addrs.begin(), addrs.end());
+
+    for (vector<Address>::iterator it = addrs.begin(); it != addrs.end();
+         ++it) {
+        reanalyzeList(m_stall_msg_map[*it], nextTick);
     }
     m_stall_msg_map.clear();
 }
@@ -331,16 +428,19 @@ MessageBuffer::stallMessage(const Address& addr)
     DPRINTF(RubyQueue, "Stalling due to %s\n", addr);
     assert(isReady());
     assert(addr.getOffset() == 0);
-    MsgPtr message = m_prio_heap.front().m_msgptr;
-
-    dequeue();
+    MessageBufferNode* node = dequeueNode();
 
     //
     // Note: no event is scheduled to analyze the map at a later time.
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    StallList &stalled = m_stall_msg_map[addr];
+    if (stalled.m_tail == NULL)
+        stalled.m_head = node;
+    else
+        stalled.m_tail->m_next = node;
+    stalled.m_tail = node;
 }
 
 void
@@ -351,25 +451,29 @@ MessageBuffer::print(ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    vector<MessageBufferNode> copy(m_prio_heap);
-    sort_heap(copy.begin(), copy.end(), greater<MessageBufferNode>());
+    vector<MessageBufferNode> copy;
+    for (const MessageBufferNode* node = m_prio_queue.begin(); node != NULL;
+         node = node->m_next) {
+        copy.push_back(*node);
+    }
     ccprintf(out, "%s] %s", copy, m_name);
 }
 
 bool
 MessageBuffer::isReady() const
 {
-    return ((m_prio_heap.size() > 0) &&
-            (m_prio_heap.front().m_time <= m_receiver->clockEdge()));
+    return (!m_prio_queue.empty() &&
+            (m_prio_queue.front().m_time <= m_receiver->clockEdge()));
 }
 
 bool
 MessageBuffer::functionalRead(Packet *pkt)
 {
-    // Check the priority heap and read any messages that may
+    // Check the priority queue and read any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].m_msgptr.get();
+    for (const MessageBufferNode* node = m_prio_queue.begin(); node != NULL;
+         node = node->m_next) {
+        Message *msg = node->m_msgptr.get();
         if (msg->functionalRead(pkt)) return true;
     }
 
@@ -379,13 +483,20 @@ MessageBuffer::functionalRead(Packet *pkt)
          map_iter != m_stall_msg_map.end();
          ++map_iter) {
 
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
+        for (MessageBufferNode* node = map_iter->second.m_head;
+             node != NULL; node = node->m_next) {
 
-            Message *msg = (*it).get();
+            Message *msg = node->m_msgptr.get();
             if (msg->functionalRead(pkt)) return true;
         }
     }
+
+    // Read the messages still on their way from another event queue.
+    std::lock_guard<std::mutex> lock(m_incoming_mutex);
+    for (unsigned int i = 0; i < m_incoming.size(); ++i) {
+        Message *msg = m_incoming[i].m_msgptr.get();
+        if (msg->functionalRead(pkt)) return true;
+    }
     return false;
 }
 
@@ -394,10 +505,11 @@ MessageBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    // Check the priority heap and write any messages that may
+    // Check the priority queue and write any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].m_msgptr.get();
+    for (const MessageBufferNode* node = m_prio_queue.begin(); node != NULL;
+         node = node->m_next) {
+        Message *msg = node->m_msgptr.get();
         if (msg->functionalWrite(pkt)) {
             num_functional_writes++;
         }
@@ -409,15 +521,24 @@ MessageBuffer::functionalWrite(Packet *pkt)
          map_iter != m_stall_msg_map.end();
          ++map_iter) {
 
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
+        for (MessageBufferNode* node = map_iter->second.m_head;
+             node != NULL; node = node->m_next) {
 
-            Message *msg = (*it).get();
+            Message *msg = node->m_msgptr.get();
             if (msg->functionalWrite(pkt)) {
                 num_functional_writes++;
             }
         }
     }
 
+    // Update the messages still on their way from another event queue.
+    std::lock_guard<std::mutex> lock(m_incoming_mutex);
+    for (unsigned int i = 0; i < m_incoming.size(); ++i) {
+        Message *msg = m_incoming[i].m_msgptr.get();
+        if (msg->functionalWrite(pkt)) {
+            num_functional_writes++;
+        }
+    }
+
     return num_functional_writes;
 }
@@ -38,12 +38,15 @@
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "base/hashmap.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/MessageBufferNode.hh"
+#include "mem/ruby/network/MessageQueue.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "mem/packet.hh"
 
@@ -51,6 +54,7 @@ class MessageBuffer
 {
   public:
     MessageBuffer(const std::string &name = "");
+    ~MessageBuffer();
 
     std::string name() const { return m_name; }
 
@@ -64,15 +68,7 @@ class MessageBuffer
     // TRUE if head of queue timestamp <= SystemTime
     bool isReady() const;
 
-    void
-    delayHead()
-    {
-        MessageBufferNode node = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MessageBufferNode>());
-        m_prio_heap.pop_back();
-        enqueue(node.m_msgptr, Cycles(1));
-    }
+    void delayHead();
 
     bool areNSlotsAvailable(unsigned int n);
     int getPriority() { return m_priority_rank; }
@@ -99,6 +95,17 @@ class MessageBuffer
         m_receiver = obj;
     }
 
+    ClockedObject* getReceiver() const { return m_receiver; }
+
+    //! TRUE if the sender and receiver run on different event queues,
+    //! i.e. potentially on different threads. Messages are then handed
+    //! over through m_incoming rather than put on the heap directly.
+    bool
+    crossesEventQueues() const
+    {
+        return m_sender->eventQueue() != m_receiver->eventQueue();
+    }
+
     void setDescription(const std::string& name) { m_name = name; }
     std::string getDescription() { return m_name;}
 
@@ -112,7 +119,7 @@ class MessageBuffer
     peekMsgPtr() const
     {
         assert(isReady());
-        return m_prio_heap.front().m_msgptr;
+        return m_prio_queue.front().m_msgptr;
     }
 
     void enqueue(MsgPtr message) { enqueue(message, Cycles(1)); }
@@ -123,7 +130,7 @@ class MessageBuffer
     Cycles dequeue();
 
     void recycle();
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
+    bool isEmpty() const { return m_prio_queue.empty(); }
 
     void
     setOrdering(bool order)
@@ -155,7 +162,39 @@ class MessageBuffer
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    //! Stalled messages of an address, in the order they stalled.
+    struct StallList
+    {
+        StallList() : m_head(NULL), m_tail(NULL) {}
+
+        MessageBufferNode* m_head;
+        MessageBufferNode* m_tail;
+    };
+
+    void reanalyzeList(StallList &, Tick);
+
+    //! Remove the message at the head of the queue, updating the size
+    //! bookkeeping, and hand over its node.
+    MessageBufferNode* dequeueNode();
+
+    //! Move the messages in m_incoming that have arrived to the heap.
+    void moveIncoming();
+
+    //! Event delivering a message from a sender on another event queue,
+    //! scheduled on the receiver's queue for the message's arrival.
+    class ArrivalEvent : public Event
+    {
+      public:
+        ArrivalEvent(MessageBuffer *buffer)
+            : Event(Async_Delivery_Pri, AutoDelete), m_buffer(buffer)
+        {
+        }
+
+        void process() { m_buffer->moveIncoming(); }
+
+      private:
+        MessageBuffer *m_buffer;
+    };
 
   private:
     //added by SS
@@ -168,11 +207,12 @@ class MessageBuffer
 
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    std::vector<MessageBufferNode> m_prio_heap;
+    MessageQueue m_prio_queue;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map< Address, std::list<MsgPtr> > StallMsgMapType;
+    // The stalled messages are linked through the nodes they had in
+    // m_prio_queue. The map is hashed, so reanalyzeAllMessages() sorts
+    // the addresses to keep a well-defined order.
+    typedef m5::hash_map<Address, StallList> StallMsgMapType;
 
     StallMsgMapType m_stall_msg_map;
     std::string m_name;
@@ -200,6 +240,12 @@ class MessageBuffer
 
     int m_input_link_id;
     int m_vnet_id;
+
+    //! Messages from a sender on another event queue that have not
+    //! arrived yet, in the order they were sent. Shared between the
+    //! sender's and the receiver's threads under m_incoming_mutex.
+    std::vector<MessageBufferNode> m_incoming;
+    std::mutex m_incoming_mutex;
 };
 
 Cycles random_time();
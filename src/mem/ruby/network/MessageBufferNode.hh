@@ -37,12 +37,13 @@ class MessageBufferNode
 {
   public:
     MessageBufferNode()
-        : m_time(0), m_msg_counter(0)
+        : m_time(0), m_msg_counter(0), m_next(NULL)
     {}
 
     MessageBufferNode(const Tick time, uint64_t counter,
                       const MsgPtr& msgptr)
-        : m_time(time), m_msg_counter(counter), m_msgptr(msgptr)
+        : m_time(time), m_msg_counter(counter), m_msgptr(msgptr),
+          m_next(NULL)
     {}
 
     void print(std::ostream& out) const;
@@ -51,6 +52,9 @@ class MessageBufferNode
     Tick m_time;
     uint64_t m_msg_counter; // FIXME, should this be a 64-bit value?
     MsgPtr m_msgptr;
+
+    //! Next node in the MessageQueue or stall list holding this node.
+    MessageBufferNode* m_next;
 };
 
 inline bool
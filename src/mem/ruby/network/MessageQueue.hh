@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Messages of a MessageBuffer, ordered by arrival time and, among
+ * messages arriving at the same time, by message counter. This is the
+ * order of the binary heap the buffer used to keep, but most messages
+ * arrive no earlier than the ones already queued, so the nodes are kept
+ * in a sorted intrusive list instead, with one bucket per arrival tick
+ * pointing at its first and last node. A message arriving at or after
+ * the last tick is appended in constant time; anything else only walks
+ * the buckets. Nodes and buckets are recycled through free lists, so a
+ * buffer in steady state does not allocate.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
+#define __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+#include "base/free_list.hh"
+#include "mem/ruby/network/MessageBufferNode.hh"
+
+class MessageQueue
+{
+  public:
+    MessageQueue()
+        : m_head(NULL), m_tail(NULL), m_size(0)
+    {}
+
+    ~MessageQueue() { clear(); }
+
+    MessageQueue(const MessageQueue &) = delete;
+    MessageQueue &operator=(const MessageQueue &) = delete;
+
+    bool empty() const { return m_head == NULL; }
+    size_t size() const { return m_size; }
+
+    //! The earliest node, the queue must not be empty.
+    const MessageBufferNode&
+    front() const
+    {
+        assert(m_head != NULL);
+        return *m_head->m_first;
+    }
+
+    //! All nodes in order, linked through m_next.
+    const MessageBufferNode*
+    begin() const
+    {
+        return m_head == NULL ? NULL : m_head->m_first;
+    }
+
+    void
+    push(Tick time, uint64_t counter, const MsgPtr& msgptr)
+    {
+        pushNode(allocNode(time, counter, msgptr));
+    }
+
+    void pop() { releaseNode(popNode()); }
+
+    //! Take a node from the pool, to be pushed later or released.
+    MessageBufferNode*
+    allocNode(Tick time, uint64_t counter, const MsgPtr& msgptr)
+    {
+        return m_node_pool.allocate(time, counter, msgptr);
+    }
+
+    //! Return a node that is not in the queue to the pool.
+    void releaseNode(MessageBufferNode* node) { m_node_pool.release(node); }
+
+    //! Insert a node from allocNode() or popNode().
+    void pushNode(MessageBufferNode* node);
+
+    //! Unlink the earliest node without releasing it.
+    MessageBufferNode* popNode();
+
+    void
+    clear()
+    {
+        while (!empty())
+            pop();
+    }
+
+  private:
+    struct Bucket
+    {
+        Bucket(Tick time, MessageBufferNode* node)
+            : m_time(time), m_first(node), m_last(node), m_next(NULL)
+        {}
+
+        Tick m_time;
+        MessageBufferNode* m_first;
+        MessageBufferNode* m_last;
+        Bucket* m_next;
+    };
+
+    //! Buckets by increasing arrival time. The nodes of a bucket are
+    //! contiguous in the list, and the last node of a bucket links to
+    //! the first node of the next one.
+    Bucket* m_head;
+    Bucket* m_tail;
+    size_t m_size;
+
+    FreeList<MessageBufferNode> m_node_pool;
+    FreeList<Bucket> m_bucket_pool;
+};
+
+inline void
+MessageQueue::pushNode(MessageBufferNode* node)
+{
+    const Tick time = node->m_time;
+    const uint64_t counter = node->m_msg_counter;
+    m_size++;
+
+    // Find the bucket for this tick, or the last one before it.
+    Bucket* prev = NULL;
+    Bucket* bucket = NULL;
+    if (m_tail != NULL && m_tail->m_time == time) {
+        bucket = m_tail;
+    } else if (m_tail != NULL && m_tail->m_time < time) {
+        prev = m_tail;
+    } else if (m_tail != NULL) {
+        bucket = m_head;
+        while (bucket->m_time < time) {
+            prev = bucket;
+            bucket = bucket->m_next;
+        }
+        if (bucket->m_time != time)
+            bucket = NULL;
+    }
+
+    if (bucket == NULL) {
+        Bucket* fresh = m_bucket_pool.allocate(time, node);
+        if (prev == NULL) {
+            node->m_next = m_head == NULL ? NULL : m_head->m_first;
+            fresh->m_next = m_head;
+            m_head = fresh;
+        } else {
+            node->m_next = prev->m_last->m_next;
+            prev->m_last->m_next = node;
+            fresh->m_next = prev->m_next;
+            prev->m_next = fresh;
+        }
+        if (fresh->m_next == NULL)
+            m_tail = fresh;
+        return;
+    }
+
+    if (counter > bucket->m_last->m_msg_counter) {
+        // The common case, a message later than all others of its tick.
+        node->m_next = bucket->m_last->m_next;
+        bucket->m_last->m_next = node;
+        bucket->m_last = node;
+        return;
+    }
+
+    MessageBufferNode* first = bucket->m_first;
+    if (counter < first->m_msg_counter) {
+        // Insert after the first node and swap the two messages, rather
+        // than finding the node before the bucket.
+        node->m_next = first->m_next;
+        first->m_next = node;
+        if (bucket->m_last == first)
+            bucket->m_last = node;
+        std::swap(node->m_msg_counter, first->m_msg_counter);
+        std::swap(node->m_msgptr, first->m_msgptr);
+        return;
+    }
+
+    assert(counter != first->m_msg_counter);
+    MessageBufferNode* after = first;
+    while (after->m_next->m_msg_counter < counter)
+        after = after->m_next;
+    assert(after->m_next->m_msg_counter != counter);
+    node->m_next = after->m_next;
+    after->m_next = node;
+}
+
+inline MessageBufferNode*
+MessageQueue::popNode()
+{
+    assert(m_head != NULL);
+    Bucket* bucket = m_head;
+    MessageBufferNode* node = bucket->m_first;
+    if (node == bucket->m_last) {
+        m_head = bucket->m_next;
+        if (m_head == NULL)
+            m_tail = NULL;
+        m_bucket_pool.release(bucket);
+    } else {
+        bucket->m_first = node->m_next;
+    }
+    node->m_next = NULL;
+    m_size--;
+    return node;
+}
+
+#endif // __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
@@ -27,6 +27,7 @@
  */
 
 #include "base/misc.hh"
+#include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/BasicLink.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/system/System.hh"
@@ -45,6 +46,9 @@ Network::Network(const Params *p)
     // Must make sure this is called after the State Machine constructors
     m_nodes = MachineType_base_number(MachineType_NUM);
     assert(m_nodes != 0);
+    fatal_if(m_nodes > NetDest::MaxMachines, "%d Ruby machines do not fit "
+             "the %d of a NetDest, rebuild with a larger MAX_RUBY_MACHINES\n",
+             m_nodes, NetDest::MaxMachines);
     assert(m_virtual_networks != 0);
 
     m_topology_ptr = new Topology(p->routers.size(), p->ext_links,
@@ -99,9 +99,19 @@ PerfectSwitch::addOutPort(const vector<MessageBuffer*>& out,
     l.m_link = m_out.size();
     m_link_order.push_back(l);
 
+    // Destinations of earlier links keep their link
+    for (int dest = routing_table_entry.nextIndex(0); dest != -1;
+         dest = routing_table_entry.nextIndex(dest + 1)) {
+        if (dest >= m_dest_link.size())
+            m_dest_link.resize(dest + 1, -1);
+        if (m_dest_link[dest] == -1)
+            m_dest_link[dest] = l.m_link;
+    }
+
     // Add to routing table
     m_out.push_back(out);
     m_routing_table.push_back(routing_table_entry);
+    m_link_dests.resize(m_out.size());
 }
 
 PerfectSwitch::~PerfectSwitch()
@@ -163,6 +173,7 @@ PerfectSwitch::operateVnet(int vnet)
                 assert(m_link_order.size() == m_routing_table.size());
                 assert(m_link_order.size() == m_out.size());
 
+                bool reordered = false;
                 if (m_network_ptr->getAdaptiveRouting()) {
                     if (m_network_ptr->isVNetOrdered(vnet)) {
                         // Don't adaptively route
@@ -186,30 +197,58 @@ PerfectSwitch::operateVnet(int vnet)
 
                         // Look at the most empty link first
                         sort(m_link_order.begin(), m_link_order.end());
+                        reordered = true;
                     }
                 }
 
-                for (int i = 0; i < m_routing_table.size(); i++) {
-                    // pick the next link to look at
-                    int link = m_link_order[i].m_link;
-                    NetDest dst = m_routing_table[link];
-                    DPRINTF(RubyNetwork, "dst: %s\n", dst);
-
-                    if (!msg_dsts.intersectionIsNotEmpty(dst))
-                        continue;
-
-                    // Remember what link we're using
-                    output_links.push_back(link);
-
-                    // Need to remember which destinations need this message in
-                    // another vector.  This Set is the intersection of the
-                    // routing_table entry and the current destination set.  The
-                    // intersection must not be empty, since we are inside "if"
-                    output_link_destinations.push_back(msg_dsts.AND(dst));
+                if (!reordered) {
+                    // Links are in the order they were added, so look
+                    // up the link of each destination rather than
+                    // intersecting with every routing table entry.
+                    for (int dest = msg_dsts.nextIndex(0); dest != -1;
+                         dest = msg_dsts.nextIndex(dest + 1)) {
+                        assert(dest < m_dest_link.size());
+                        int link = m_dest_link[dest];
+                        assert(link != -1);
+                        if (m_link_dests[link].isEmpty())
+                            output_links.push_back(link);
+                        m_link_dests[link].addIndex(dest);
+                    }
 
-                    // Next, we update the msg_destination not to include
-                    // those nodes that were already handled by this link
-                    msg_dsts.removeNetDest(dst);
+                    // Go out on the links in link order, as below
+                    sort(output_links.begin(), output_links.end());
+                    for (int i = 0; i < output_links.size(); i++) {
+                        NetDest &dests = m_link_dests[output_links[i]];
+                        output_link_destinations.push_back(dests);
+                        dests.clear();
+                    }
+                    msg_dsts.clear();
+                } else {
+                    for (int i = 0; i < m_routing_table.size(); i++) {
+                        // pick the next link to look at
+                        int link = m_link_order[i].m_link;
+                        const NetDest &dst = m_routing_table[link];
+                        DPRINTF(RubyNetwork, "dst: %s\n", dst);
+
+                        if (!msg_dsts.intersectionIsNotEmpty(dst))
+                            continue;
+
+                        // Remember what link we're using
+                        output_links.push_back(link);
+
+                        // Need to remember which destinations need this
+                        // message in another vector.  This Set is the
+                        // intersection of the routing_table entry and the
+                        // current destination set.  The intersection must
+                        // not be empty, since we are inside "if"
+                        output_link_destinations.push_back(
+                            msg_dsts.AND(dst));
+
+                        // Next, we update the msg_destination not to
+                        // include those nodes that were already handled
+                        // by this link
+                        msg_dsts.removeNetDest(dst);
+                    }
                 }
 
                 assert(msg_dsts.count() == 0);
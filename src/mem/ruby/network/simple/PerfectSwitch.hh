@@ -95,6 +95,15 @@ class PerfectSwitch : public Consumer
     std::vector<NetDest> m_routing_table;
     std::vector<LinkOrder> m_link_order;
 
+    //! The first link, in the order links were added, whose routing
+    //! table entry holds each destination, by NetDest index; -1 if none.
+    //! Unless links are reordered adaptively, this is the link a
+    //! message goes out on for that destination.
+    std::vector<int> m_dest_link;
+
+    //! Destinations of a message per output link, while routing it.
+    std::vector<NetDest> m_link_dests;
+
     uint32_t m_virtual_networks;
     int m_round_robin_start;
     int m_wakeups_wo_switch;
@@ -63,6 +63,26 @@ Switch::init()
     m_perfect_switch->init(m_network_ptr);
 }
 
+void
+Switch::startup()
+{
+    BasicRouter::startup();
+
+    // The links, and the controllers at their far ends, are only all
+    // hooked up once every object is initialized. A message crossing a
+    // link takes at least its latency, which is the lookahead between
+    // this switch's event queue and that of the link's far end.
+    for (auto& throttle : m_throttles) {
+        Tick latency = clockPeriod() * throttle->getLatency();
+        for (auto& out : throttle->getOutBuffers()) {
+            if (out != nullptr && out->getReceiver() != nullptr) {
+                registerLookahead(eventQueue(),
+                                  out->getReceiver()->eventQueue(), latency);
+            }
+        }
+    }
+}
+
 void
 Switch::addInPort(const vector<MessageBuffer*>& in)
 {
@@ -61,6 +61,7 @@ class Switch : public BasicRouter
     Switch(const Params *p);
     ~Switch();
     void init();
+    void startup();
 
     void addInPort(const std::vector<MessageBuffer*>& in);
     void addOutPort(const std::vector<MessageBuffer*>& out,
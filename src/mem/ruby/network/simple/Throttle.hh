@@ -76,6 +76,8 @@ class Throttle : public Consumer
     { return m_endpoint_bandwidth * m_link_bandwidth_multiplier; }
 
     Cycles getLatency() const { return m_link_latency; }
+    const std::vector<MessageBuffer*> & getOutBuffers() const
+    { return m_out; }
 
     void clearStats();
     void collateStats();
@@ -26,7 +26,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "cpu/acc_task_data.hh"
 #include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
+#include "mem/ruby/system/Sequencer.hh"
 
 AbstractCacheEntry::AbstractCacheEntry()
 {
@@ -34,6 +36,8 @@ AbstractCacheEntry::AbstractCacheEntry()
     m_Address.setAddress(0);
     m_locked = -1;
     enableCtr = 0;
+    hasVaddr = false;
+    m_accTaskData = nullptr;
 }
 
 AbstractCacheEntry::~AbstractCacheEntry()
@@ -57,48 +61,29 @@ AbstractCacheEntry::setCtr(int _enableCtr)
 }
 
 void 
-AbstractCacheEntry::setVirtAddr(Packet *pkt)
+AbstractCacheEntry::setVirtAddr(Packet *pkt, const Sequencer &sequencer)
 {
-    if(pkt->req->hasVaddr() && forwardAccTaskData) {
+    m_accTaskData = pkt->req->hasVaddr() ?
+        sequencer.forwardedAccTaskData(pkt) : nullptr;
+    if(m_accTaskData) {
       Address reqVaddr(pkt->req->getVaddr());
       reqVaddr.makeLineAddress();
       m_vAddress = reqVaddr;
-        /*if(cpuPtr->checkAccTaskData(pkt->req->getVaddr())) {
-          printf("Set virtual Address for Acc-task data: %x\n", pkt->req->getVaddr());
-          printf("Set virtual Address(Line) for Acc-task data: %x\n", m_vAddress.getAddress());
-        }*/
-        auto vaddr = m_vAddress.getAddress();
-        if(cpuPtr->checkAccTaskData(vaddr) && pkt->isWrite()) {
-          cpuPtr->incAccTaskDataInCache(vaddr);
-          cpuPtr->incAccTaskDataCtr(vaddr, pkt->getSize());
-        }
+      if (pkt->isWrite()) {
+        m_accTaskData->recordWrite(m_vAddress.getAddress(), pkt->getSize());
+      }
       hasVaddr = true;
     } else {
       hasVaddr = false;
     }
 }
 
-static unsigned accumBytes = 0;
-
 bool 
 AbstractCacheEntry::checkAccTaskData()
 {
-    if(forwardAccTaskData && hasVaddr) {
-			auto range = cpuPtr->getAccTaskDataRange();
-			auto vaddr = m_vAddress.getAddress();
-			if(cpuPtr->checkAccTaskDataCtr(vaddr) && enableCtr) {
-				printf("Evict req %x fall in Acc-task data range %x - %x(ctr enable)\n",
-						vaddr, range.first, range.second); 
-				return true;
-			}
-			if(cpuPtr->checkAccTaskData(vaddr)) {
-        accumBytes += 64;
-				printf("Evict req %x fall in Acc-task data range %x - %x(ctr disable), accum: %d\n",
-						vaddr, range.first, range.second, accumBytes); 
-        cpuPtr->decAccTaskDataInCache(vaddr);
-        return true;
-			}
-			return false;
+    if(m_accTaskData && hasVaddr) {
+      return m_accTaskData->recordEviction(m_vAddress.getAddress(),
+                                           enableCtr);
     } else {
         return false;
     }
@@ -36,17 +36,15 @@
 #include <iostream>
 
 #include "base/misc.hh"
-#include "cpu/base.hh"
 #include "mem/packet.hh"
 #include "mem/protocol/AccessPermission.hh"
 #include "mem/request.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/slicc_interface/AbstractEntry.hh"
 
-extern bool forwardAccTaskData;
-extern BaseCPU *cpuPtr;
-
+class AccTaskDataRegistry;
 class DataBlock;
+class Sequencer;
 
 class AbstractCacheEntry : public AbstractEntry
 {
@@ -57,7 +55,7 @@ class AbstractCacheEntry : public AbstractEntry
     // Get/Set permission of the entry
     void changePermission(AccessPermission new_perm);
 
-    void setVirtAddr(Packet *pkt);
+    void setVirtAddr(Packet *pkt, const Sequencer &sequencer);
     void setCtr(int _enableCtr);
     bool checkAccTaskData();
     Address getVirtAddr();
@@ -74,6 +72,9 @@ class AbstractCacheEntry : public AbstractEntry
                   // required for implementing LL/SC
     bool hasVaddr;
     bool enableCtr;
+    // Task data registry of the context that brought in this block, if
+    // its data is being forwarded to an accelerator
+    AccTaskDataRegistry *m_accTaskData;
 };
 
 inline std::ostream&
@@ -305,7 +305,7 @@ AbstractController::recvTimingResp(PacketPtr pkt)
 {
     assert(pkt->isResponse());
 
-    std::shared_ptr<MemoryMsg> msg = std::make_shared<MemoryMsg>(clockEdge());
+    std::shared_ptr<MemoryMsg> msg = allocateMessage<MemoryMsg>(clockEdge());
     (*msg).m_Addr.setAddress(pkt->getAddr());
     (*msg).m_Sender = m_machineID;
 
@@ -29,9 +29,12 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
-#include <stack>
+#include <new>
+#include <utility>
+#include <vector>
 
 #include "mem/packet.hh"
 
@@ -45,14 +48,12 @@ class Message
         : m_time(curTime),
           m_LastEnqueueTime(curTime),
           m_DelayedTicks(0)
-    {
-      timeStamps.push(curTime);
-    }
+    { }
 
     Message(const Message &other)
         : m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
-          m_DelayedTicks(other.m_DelayedTicks), timeStamps(other.timeStamps)
+          m_DelayedTicks(other.m_DelayedTicks)
     { }
 
     virtual ~Message() { }
@@ -93,9 +94,86 @@ class Message
     Tick m_time;
     Tick m_LastEnqueueTime; // my last enqueue time
     Tick m_DelayedTicks; // my delayed cycles
-    std::stack<Tick> timeStamps;
 };
 
+/**
+ * Allocator recycling the storage of messages, together with the
+ * reference count of their shared pointers, so that creating a message
+ * does not go to the heap in steady state. Released blocks are kept per
+ * thread and per type; a message may be released by another thread
+ * than the one that created it, as the blocks of a type all have the
+ * same size.
+ */
+template <class T>
+class MessageAllocator
+{
+  public:
+    typedef T value_type;
+
+    //! Most blocks of a type kept by each thread.
+    static const size_t MaxBlocks = 4096;
+
+    MessageAllocator() {}
+    template <class U> MessageAllocator(const MessageAllocator<U> &) {}
+
+    T*
+    allocate(size_t n)
+    {
+        std::vector<void *> &blocks = freeBlocks();
+        if (n != 1 || blocks.empty())
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        void *block = blocks.back();
+        blocks.pop_back();
+        return static_cast<T*>(block);
+    }
+
+    void
+    deallocate(T* ptr, size_t n)
+    {
+        std::vector<void *> &blocks = freeBlocks();
+        if (n != 1 || blocks.size() >= MaxBlocks)
+            ::operator delete(ptr);
+        else
+            blocks.push_back(ptr);
+    }
+
+  private:
+    static std::vector<void *>&
+    freeBlocks()
+    {
+        // Only trivial types can be thread local with __thread, and the
+        // blocks are needed until the thread exits, so the list is
+        // never freed.
+        static __thread std::vector<void *> *blocks = NULL;
+        if (blocks == NULL)
+            blocks = new std::vector<void *>();
+        return *blocks;
+    }
+};
+
+template <class T, class U>
+inline bool
+operator==(const MessageAllocator<T> &, const MessageAllocator<U> &)
+{
+    return true;
+}
+
+template <class T, class U>
+inline bool
+operator!=(const MessageAllocator<T> &, const MessageAllocator<U> &)
+{
+    return false;
+}
+
+//! Create a message, in storage recycled by MessageAllocator.
+template <class T, typename... Args>
+inline std::shared_ptr<T>
+allocateMessage(Args&&... args)
+{
+    return std::allocate_shared<T>(MessageAllocator<T>(),
+                                   std::forward<Args>(args)...);
+}
+
 inline std::ostream&
 operator<<(std::ostream& out, const Message& obj)
 {
@@ -72,7 +72,7 @@ class RubyRequest : public Message
 
     RubyRequest(Tick curTime) : Message(curTime) {}
     MsgPtr clone() const
-    { return std::shared_ptr<Message>(new RubyRequest(*this)); }
+    { return allocateMessage<RubyRequest>(*this); }
 
     const Address& getLineAddress() const { return m_LineAddress; }
     const Address& getPhysicalAddress() const { return m_PhysicalAddress; }
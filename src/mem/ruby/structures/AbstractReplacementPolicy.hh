@@ -29,6 +29,8 @@
 #ifndef __MEM_RUBY_STRUCTURES_ABSTRACTREPLACEMENTPOLICY_HH__
 #define __MEM_RUBY_STRUCTURES_ABSTRACTREPLACEMENTPOLICY_HH__
 
+#include <vector>
+
 #include "base/types.hh"
 
 class AbstractReplacementPolicy
@@ -47,9 +49,15 @@ class AbstractReplacementPolicy
     Tick getLastAccess(uint64_t set, uint64_t way);
 
   protected:
+    /* timestamp of the last reference to a way of a set */
+    Tick &lastRef(uint64_t set, uint64_t way)
+    { return m_last_ref[set * m_assoc + way]; }
+    Tick lastRef(uint64_t set, uint64_t way) const
+    { return m_last_ref[set * m_assoc + way]; }
+
     unsigned m_num_sets;       /** total number of sets */
     unsigned m_assoc;          /** set associativity */
-    Tick **m_last_ref_ptr;         /** timestamp of last reference */
+    std::vector<Tick> m_last_ref;  /** timestamps, one set after the other */
 };
 
 inline
@@ -58,32 +66,18 @@ AbstractReplacementPolicy::AbstractReplacementPolicy(uint64_t num_sets,
 {
     m_num_sets = num_sets;
     m_assoc = assoc;
-    m_last_ref_ptr = new Tick*[m_num_sets];
-    for(unsigned i = 0; i < m_num_sets; i++){
-        m_last_ref_ptr[i] = new Tick[m_assoc];
-        for(unsigned j = 0; j < m_assoc; j++){
-            m_last_ref_ptr[i][j] = 0;
-        }
-    }
+    m_last_ref.assign((uint64_t)m_num_sets * m_assoc, 0);
 }
 
 inline
 AbstractReplacementPolicy::~AbstractReplacementPolicy()
 {
-    if (m_last_ref_ptr != NULL){
-        for (unsigned i = 0; i < m_num_sets; i++){
-            if (m_last_ref_ptr[i] != NULL){
-                delete[] m_last_ref_ptr[i];
-            }
-        }
-        delete[] m_last_ref_ptr;
-    }
 }
 
 inline Tick
 AbstractReplacementPolicy::getLastAccess(uint64_t set, uint64_t way)
 {
-    return m_last_ref_ptr[set][way];
+    return lastRef(set, way);
 }
 
 #endif // __MEM_RUBY_STRUCTURES_ABSTRACTREPLACEMENTPOLICY_HH__
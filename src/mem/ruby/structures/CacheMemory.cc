@@ -83,24 +83,16 @@ CacheMemory::init()
     else
         assert(false);
 
-    m_cache.resize(m_cache_num_sets);
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        m_cache[i].resize(m_cache_assoc);
-        for (int j = 0; j < m_cache_assoc; j++) {
-            m_cache[i][j] = NULL;
-        }
-    }
+    m_tags.assign((int64)m_cache_num_sets * m_cache_assoc, InvalidTag);
+    m_entries.assign((int64)m_cache_num_sets * m_cache_assoc, NULL);
 }
 
 CacheMemory::~CacheMemory()
 {
     if (m_replacementPolicy_ptr != NULL)
         delete m_replacementPolicy_ptr;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            delete m_cache[i][j];
-        }
-    }
+    for (auto entry : m_entries)
+        delete entry;
 }
 
 // convert a Address to its location in the cache
@@ -117,13 +109,10 @@ CacheMemory::addressToCacheSet(const Address& address) const
 int
 CacheMemory::findTagInSet(int64 cacheSet, const Address& tag) const
 {
-    assert(tag == line_address(tag));
-    // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
+    int loc = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (loc != -1 &&
+        entryAt(cacheSet, loc)->m_Permission != AccessPermission_NotPresent)
+        return loc;
     return -1; // Not found
 }
 
@@ -134,11 +123,15 @@ CacheMemory::findTagInSetIgnorePermissions(int64 cacheSet,
                                            const Address& tag) const
 {
     assert(tag == line_address(tag));
-    // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
-    return -1; // Not found
+    // search the set for the tag, which is held by at most one way;
+    // scanning every way rather than stopping at a match keeps the
+    // loop free of branches, so that it can be vectorized
+    const Addr *tags = &m_tags[cacheSet * m_cache_assoc];
+    Addr line = tag.getAddress();
+    int loc = -1;
+    for (int i = 0; i < m_cache_assoc; i++)
+        loc = tags[i] == line ? i : loc;
+    return loc;
 }
 
 bool
@@ -151,7 +144,7 @@ CacheMemory::tryCacheAccess(const Address& address, RubyRequestType type,
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
+        AbstractCacheEntry* entry = entryAt(cacheSet, loc);
         m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
         data_ptr = &(entry->getDataBlk());
 
@@ -179,12 +172,11 @@ CacheMemory::testCacheAccess(const Address& address, RubyRequestType type,
 
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
+        AbstractCacheEntry* entry = entryAt(cacheSet, loc);
         m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
         data_ptr = &(entry->getDataBlk());
 
-        return m_cache[cacheSet][loc]->m_Permission !=
-            AccessPermission_NotPresent;
+        return entry->m_Permission != AccessPermission_NotPresent;
     }
 
     data_ptr = NULL;
@@ -219,7 +211,7 @@ CacheMemory::cacheAvail(const Address& address) const
     int64 cacheSet = addressToCacheSet(address);
 
     for (int i = 0; i < m_cache_assoc; i++) {
-        AbstractCacheEntry* entry = m_cache[cacheSet][i];
+        AbstractCacheEntry* entry = entryAt(cacheSet, i);
         if (entry != NULL) {
             if (entry->m_Address == address ||
                 entry->m_Permission == AccessPermission_NotPresent) {
@@ -243,7 +235,15 @@ CacheMemory::allocate(const Address& address, AbstractCacheEntry* entry)
 
     // Find the first open slot
     int64 cacheSet = addressToCacheSet(address);
-    std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
+    AbstractCacheEntry** set = &m_entries[cacheSet * m_cache_assoc];
+    Addr* tags = &m_tags[cacheSet * m_cache_assoc];
+
+    // a way may still hold this address without permissions, drop its
+    // tag so that the address is only found in the new way
+    int stale = findTagInSetIgnorePermissions(cacheSet, address);
+    if (stale != -1)
+        tags[stale] = InvalidTag;
+
     for (int i = 0; i < m_cache_assoc; i++) {
         if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
             set[i] = entry;  // Init entry
@@ -252,7 +252,7 @@ CacheMemory::allocate(const Address& address, AbstractCacheEntry* entry)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            tags[i] = address.getAddress();
 
             m_replacementPolicy_ptr->touch(cacheSet, i, curTick());
             return entry;
@@ -270,9 +270,9 @@ CacheMemory::deallocate(const Address& address)
     int64 cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
-        delete m_cache[cacheSet][loc];
-        m_cache[cacheSet][loc] = NULL;
-        m_tag_index.erase(address);
+        delete entryAt(cacheSet, loc);
+        entryAt(cacheSet, loc) = NULL;
+        m_tags[cacheSet * m_cache_assoc + loc] = InvalidTag;
     }
 }
 
@@ -284,7 +284,7 @@ CacheMemory::cacheProbe(const Address& address) const
     assert(!cacheAvail(address));
 
     int64 cacheSet = addressToCacheSet(address);
-    return m_cache[cacheSet][m_replacementPolicy_ptr->getVictim(cacheSet)]->
+    return entryAt(cacheSet, m_replacementPolicy_ptr->getVictim(cacheSet))->
         m_Address;
 }
 
@@ -296,7 +296,7 @@ CacheMemory::lookup(const Address& address)
     int64 cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if(loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return entryAt(cacheSet, loc);
 }
 
 // looks an address up in the cache
@@ -307,7 +307,7 @@ CacheMemory::lookup(const Address& address) const
     int64 cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if(loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return entryAt(cacheSet, loc);
 }
 
 
@@ -331,8 +331,8 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
 
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                AccessPermission perm = m_cache[i][j]->m_Permission;
+            if (entryAt(i, j) != NULL) {
+                AccessPermission perm = entryAt(i, j)->m_Permission;
                 RubyRequestType request_type = RubyRequestType_NULL;
                 if (perm == AccessPermission_Read_Only) {
                     if (m_is_instruction_only_cache) {
@@ -345,10 +345,10 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
                 }
 
                 if (request_type != RubyRequestType_NULL) {
-                    tr->addRecord(cntrl, m_cache[i][j]->m_Address.getAddress(),
+                    tr->addRecord(cntrl, entryAt(i, j)->m_Address.getAddress(),
                                   0, request_type,
                                   m_replacementPolicy_ptr->getLastAccess(i, j),
-                                  m_cache[i][j]->getDataBlk());
+                                  entryAt(i, j)->getDataBlk());
                     warmedUpBlocks++;
                 }
             }
@@ -367,10 +367,10 @@ CacheMemory::print(ostream& out) const
     out << "Cache dump: " << name() << endl;
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
+            if (entryAt(i, j) != NULL) {
                 out << "  Index: " << i
                     << " way: " << j
-                    << " entry: " << *m_cache[i][j] << endl;
+                    << " entry: " << *entryAt(i, j) << endl;
             } else {
                 out << "  Index: " << i
                     << " way: " << j
@@ -394,7 +394,7 @@ CacheMemory::setLocked(const Address& address, int context)
     int64 cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->m_locked = context;
+    entryAt(cacheSet, loc)->m_locked = context;
 }
 
 void
@@ -405,7 +405,7 @@ CacheMemory::clearLocked(const Address& address)
     int64 cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->m_locked = -1;
+    entryAt(cacheSet, loc)->m_locked = -1;
 }
 
 bool
@@ -416,8 +416,8 @@ CacheMemory::isLocked(const Address& address, int context)
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
     DPRINTF(RubyCache, "Testing Lock for addr: %llx cur %d con %d\n",
-            address, m_cache[cacheSet][loc]->m_locked, context);
-    return m_cache[cacheSet][loc]->m_locked == context;
+            address, entryAt(cacheSet, loc)->m_locked, context);
+    return entryAt(cacheSet, loc)->m_locked == context;
 }
 
 void
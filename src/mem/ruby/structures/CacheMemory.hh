@@ -32,7 +32,6 @@
 #include <string>
 #include <vector>
 
-#include "base/hashmap.hh"
 #include "base/statistics.hh"
 #include "mem/protocol/CacheRequestType.hh"
 #include "mem/protocol/CacheResourceType.hh"
@@ -141,6 +140,12 @@ class CacheMemory : public SimObject
     int findTagInSetIgnorePermissions(int64 cacheSet,
                                       const Address& tag) const;
 
+    // The entry in a way of a set
+    AbstractCacheEntry*& entryAt(int64 cacheSet, int way)
+    { return m_entries[cacheSet * m_cache_assoc + way]; }
+    AbstractCacheEntry* entryAt(int64 cacheSet, int way) const
+    { return m_entries[cacheSet * m_cache_assoc + way]; }
+
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
     CacheMemory& operator=(const CacheMemory& obj);
@@ -151,10 +156,15 @@ class CacheMemory : public SimObject
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    m5::hash_map<Address, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    // The line address held by each way, one set after the other, so
+    // that a lookup scans a single contiguous run of tags. Ways that
+    // hold nothing are marked with InvalidTag, which as it is not
+    // block aligned never matches a line address.
+    static const Addr InvalidTag = ~Addr(0);
+    std::vector<Addr> m_tags;
+
+    // The entry of each way, laid out like the tags
+    std::vector<AbstractCacheEntry*> m_entries;
 
     AbstractReplacementPolicy *m_replacementPolicy_ptr;
 
@@ -60,7 +60,7 @@ LRUPolicy::touch(uint64_t set, uint64_t index, Tick time)
     assert(index >= 0 && index < m_assoc);
     assert(set >= 0 && set < m_num_sets);
 
-    m_last_ref_ptr[set][index] = time;
+    lastRef(set, index) = time;
 }
 
 inline uint64_t
@@ -70,11 +70,14 @@ LRUPolicy::getVictim(uint64_t set) const
     Tick time, smallest_time;
     uint64_t smallest_index;
 
+    // the timestamps of a set are contiguous
+    const Tick *last_ref = &m_last_ref[set * m_assoc];
+
     smallest_index = 0;
-    smallest_time = m_last_ref_ptr[set][0];
+    smallest_time = last_ref[0];
 
     for (unsigned i = 0; i < m_assoc; i++) {
-        time = m_last_ref_ptr[set][i];
+        time = last_ref[i];
         // assert(m_cache[cacheSet][i].m_Permission !=
         //     AccessPermission_NotPresent);
 
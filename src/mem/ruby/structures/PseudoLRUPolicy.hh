@@ -111,7 +111,7 @@ PseudoLRUPolicy::touch(uint64_t set, uint64_t index, Tick time)
             m_trees[set] &= ~(1 << tree_index);
         tree_index = node_val ? (tree_index*2)+2 : (tree_index*2)+1;
     }
-    m_last_ref_ptr[set][index] = time;
+    lastRef(set, index) = time;
 }
 
 inline uint64_t
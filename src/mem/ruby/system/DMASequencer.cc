@@ -316,7 +316,7 @@ DMASequencer::makeRequest(PacketPtr pkt)
     DPRINTF(RubyDma, "DMA req created: addr %p, len %d\n", line_addr, len);
 
     std::shared_ptr<SequencerMsg> msg =
-        std::make_shared<SequencerMsg>(clockEdge());
+        allocateMessage<SequencerMsg>(clockEdge());
     msg->getPhysicalAddress() = Address(paddr);
     // TEST
     // msg->getLineAddress() = line_address(msg->getPhysicalAddress());
@@ -378,7 +378,7 @@ DMASequencer::issueNext(const Address& address)
     }
 
     std::shared_ptr<SequencerMsg> msg =
-        std::make_shared<SequencerMsg>(clockEdge());
+        allocateMessage<SequencerMsg>(clockEdge());
     msg->getPhysicalAddress() = Address(active_request.start_paddr +
                                        active_request.bytes_completed);
 
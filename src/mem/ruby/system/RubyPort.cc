@@ -337,6 +337,14 @@ RubyPort::MemSlavePort::recvFunctional(PacketPtr pkt)
     }
 }
 
+AccTaskDataRegistry *
+RubyPort::forwardedAccTaskData(PacketPtr pkt) const
+{
+    if (!pkt->req->hasContextId())
+        return nullptr;
+    return system->forwardedAccTaskData(pkt->req->contextId());
+}
+
 void
 RubyPort::ruby_hit_callback(PacketPtr pkt)
 {
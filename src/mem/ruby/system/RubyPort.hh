@@ -53,6 +53,7 @@
 #include "params/RubyPort.hh"
 
 class AbstractController;
+class AccTaskDataRegistry;
 
 class RubyPort : public MemObject
 {
@@ -164,6 +165,12 @@ class RubyPort : public MemObject
     uint32_t getId() { return m_version; }
     unsigned int drain(DrainManager *dm);
 
+    /**
+     * Get the accelerator task data registry of the context that issued
+     * a packet, or nullptr if that context's data is not forwarded.
+     */
+    AccTaskDataRegistry *forwardedAccTaskData(PacketPtr pkt) const;
+
   protected:
     void ruby_hit_callback(PacketPtr pkt);
     void testDrainComplete();
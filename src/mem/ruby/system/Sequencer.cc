@@ -246,7 +246,7 @@ Sequencer::insertRequest(PacketPtr pkt, RubyRequestType request_type)
             m_writeRequestTable.insert(default_entry);
         if (r.second) {
             RequestTable::iterator i = r.first;
-            i->second = new SequencerRequest(pkt, request_type, curCycle());
+            i->second = m_requestPool.allocate(pkt, request_type, curCycle());
             m_outstanding_count++;
         } else {
           // There is an outstanding write request for the cache line
@@ -266,7 +266,7 @@ Sequencer::insertRequest(PacketPtr pkt, RubyRequestType request_type)
 
         if (r.second) {
             RequestTable::iterator i = r.first;
-            i->second = new SequencerRequest(pkt, request_type, curCycle());
+            i->second = m_requestPool.allocate(pkt, request_type, curCycle());
             m_outstanding_count++;
         } else {
             // There is an outstanding read request for the cache line
@@ -555,7 +555,7 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
         testerSenderState->subBlock.mergeFrom(data);
     }
 
-    delete srequest;
+    m_requestPool.release(srequest);
 
     if (RubySystem::getWarmupEnabled()) {
         assert(pkt->req);
@@ -679,12 +679,12 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
     // check if the packet has data as for example prefetch and flush
     // requests do not
     std::shared_ptr<RubyRequest> msg =
-        std::make_shared<RubyRequest>(clockEdge(), pkt->getAddr(),
-                                      pkt->isFlush() ?
-                                      nullptr : pkt->getPtr<uint8_t>(),
-                                      pkt->getSize(), pc, secondary_type,
-                                      RubyAccessMode_Supervisor, pkt,
-                                      PrefetchBit_No, proc_id);
+        allocateMessage<RubyRequest>(clockEdge(), pkt->getAddr(),
+                                     pkt->isFlush() ?
+                                     nullptr : pkt->getPtr<uint8_t>(),
+                                     pkt->getSize(), pc, secondary_type,
+                                     RubyAccessMode_Supervisor, pkt,
+                                     PrefetchBit_No, proc_id);
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %s %s\n",
             curTick(), m_version, "Seq", "Begin", "", "",
@@ -773,6 +773,11 @@ Sequencer::regStats()
         .name(name() + ".load_waiting_on_store")
         .desc("Number of times a load aliased with a pending store")
         .flags(Stats::nozero);
+    m_request_heap_allocs
+        .method(this, &Sequencer::requestHeapAllocs)
+        .name(name() + ".request_heap_allocs")
+        .desc("Number of outstanding request entries allocated from the "
+              "heap rather than recycled");
 
     // These statistical variables are not for display.
     // The profiler will collate these across different
@@ -31,6 +31,7 @@
 
 #include <iostream>
 
+#include "base/free_list.hh"
 #include "base/hashmap.hh"
 #include "mem/protocol/MachineType.hh"
 #include "mem/protocol/RubyRequestType.hh"
@@ -183,6 +184,8 @@ class Sequencer : public RubyPort
     typedef m5::hash_map<Address, SequencerRequest*> RequestTable;
     RequestTable m_writeRequestTable;
     RequestTable m_readRequestTable;
+    //! Recycled storage for the entries of the request tables.
+    FreeList<SequencerRequest> m_requestPool;
     // Global outstanding request count, across all request tables
     int m_outstanding_count;
     bool m_deadlock_check_scheduled;
@@ -193,6 +196,11 @@ class Sequencer : public RubyPort
     Stats::Scalar m_load_waiting_on_store;
     Stats::Scalar m_load_waiting_on_load;
 
+    //! Number of request table entries allocated from the heap.
+    Stats::Value m_request_heap_allocs;
+    uint64_t requestHeapAllocs() const
+    { return m_requestPool.heapAllocations(); }
+
     bool m_usingNetworkTester;
 
     //! Histogram for number of outstanding requests per cycle.
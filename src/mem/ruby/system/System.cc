@@ -29,10 +29,12 @@
 #include <fcntl.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdio>
 
 #include "base/intmath.hh"
 #include "base/statistics.hh"
+#include "base/time.hh"
 #include "debug/RubyCacheTrace.hh"
 #include "debug/RubySystem.hh"
 #include "mem/ruby/common/Address.hh"
@@ -56,7 +58,8 @@ unsigned RubySystem::m_systems_to_warmup = 0;
 bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params *p)
-    : ClockedObject(p), m_access_backing_store(p->access_backing_store)
+    : ClockedObject(p), m_access_backing_store(p->access_backing_store),
+      m_functional_host_seconds(0)
 {
     if (g_system_ptr != NULL)
         fatal("Only one RubySystem object currently allowed.\n");
@@ -96,6 +99,59 @@ RubySystem::registerAbstractController(AbstractController* cntrl)
 
   MachineID id = cntrl->getMachineID();
   g_abs_controls[id.getType()][id.getNum()] = cntrl;
+
+  if (id.getType() == MachineType_Directory)
+      m_dir_cntrl_vec.push_back(cntrl);
+}
+
+std::unique_lock<std::mutex>
+RubySystem::lockShared()
+{
+    if (numMainEventQueues > 1)
+        return std::unique_lock<std::mutex>(m_shared_mutex);
+    return std::unique_lock<std::mutex>();
+}
+
+void
+RubySystem::setLineHolder(AbstractController *cntrl, const Address &addr,
+                          bool holds)
+{
+    if (cntrl->getType() == MachineType_Directory)
+        return;
+
+    Address line = line_address(addr);
+
+    // controllers on parallel event queues transition concurrently
+    std::unique_lock<std::mutex> lock = lockShared();
+    auto it = m_line_holders.find(line.getAddress());
+    if (it == m_line_holders.end()) {
+        if (holds)
+            m_line_holders[line.getAddress()].push_back(cntrl);
+        return;
+    }
+
+    std::vector<AbstractController *> &holders = it->second;
+    auto h = std::find(holders.begin(), holders.end(), cntrl);
+    if (holds && h == holders.end()) {
+        holders.push_back(cntrl);
+    } else if (!holds && h != holders.end()) {
+        *h = holders.back();
+        holders.pop_back();
+        if (holders.empty())
+            m_line_holders.erase(it);
+    }
+}
+
+vector<AbstractController *>
+RubySystem::getLineHolders(const Address &line)
+{
+    vector<AbstractController *> cntrls(m_dir_cntrl_vec);
+
+    std::unique_lock<std::mutex> lock = lockShared();
+    auto it = m_line_holders.find(line.getAddress());
+    if (it != m_line_holders.end())
+        cntrls.insert(cntrls.end(), it->second.begin(), it->second.end());
+    return cntrls;
 }
 
 RubySystem::~RubySystem()
@@ -335,10 +391,34 @@ RubySystem::RubyEvent::process()
     }
 }
 
+void
+RubySystem::regStats()
+{
+    m_profiler->regStats(name());
+
+    m_functional_reads
+        .name(name() + ".functional_reads")
+        .desc("Number of functional reads")
+        ;
+
+    m_functional_writes
+        .name(name() + ".functional_writes")
+        .desc("Number of functional writes")
+        ;
+
+    m_functional_host_time
+        .scalar(m_functional_host_seconds)
+        .name(name() + ".functional_host_seconds")
+        .desc("Host time spent on functional accesses")
+        .precision(6)
+        ;
+}
+
 void
 RubySystem::resetStats()
 {
     g_ruby_start = curCycle();
+    m_functional_host_seconds = 0;
 }
 
 bool
@@ -349,9 +429,19 @@ RubySystem::functionalRead(PacketPtr pkt)
     line_address.makeLineAddress();
 
     AccessPermission access_perm = AccessPermission_NotPresent;
-    int num_controllers = m_abs_cntrl_vec.size();
 
-    DPRINTF(RubySystem, "Functional Read request for %s\n",address);
+    Time start;
+    start.setTimer();
+
+    // controllers that do not hold the line are Invalid or NotPresent
+    // and cannot supply it, so only the holders need to be counted
+    vector<AbstractController *> cntrls = getLineHolders(line_address);
+    int num_controllers = cntrls.size();
+
+    DPRINTF(RubySystem, "Functional Read request for %s, %d holders\n",
+            address, num_controllers);
+
+    bool read = false;
 
     unsigned int num_ro = 0;
     unsigned int num_rw = 0;
@@ -362,7 +452,7 @@ RubySystem::functionalRead(PacketPtr pkt)
     // In this loop we count the number of controllers that have the given
     // address in read only, read write and busy states.
     for (unsigned int i = 0; i < num_controllers; ++i) {
-        access_perm = m_abs_cntrl_vec[i]-> getAccessPermission(line_address);
+        access_perm = cntrls[i]->getAccessPermission(line_address);
         if (access_perm == AccessPermission_Read_Only)
             num_ro++;
         else if (access_perm == AccessPermission_Read_Write)
@@ -392,10 +482,11 @@ RubySystem::functionalRead(PacketPtr pkt)
     if (num_invalid == (num_controllers - 1) && num_backing_store == 1) {
         DPRINTF(RubySystem, "only copy in Backing_Store memory, read from it\n");
         for (unsigned int i = 0; i < num_controllers; ++i) {
-            access_perm = m_abs_cntrl_vec[i]->getAccessPermission(line_address);
+            access_perm = cntrls[i]->getAccessPermission(line_address);
             if (access_perm == AccessPermission_Backing_Store) {
-                m_abs_cntrl_vec[i]->functionalRead(line_address, pkt);
-                return true;
+                cntrls[i]->functionalRead(line_address, pkt);
+                read = true;
+                break;
             }
         }
     } else if (num_ro > 0 || num_rw == 1) {
@@ -409,16 +500,24 @@ RubySystem::functionalRead(PacketPtr pkt)
         // a read write copy of the given address. Any valid copy would suffice
         // for a functional read.
         for (unsigned int i = 0;i < num_controllers;++i) {
-            access_perm = m_abs_cntrl_vec[i]->getAccessPermission(line_address);
+            access_perm = cntrls[i]->getAccessPermission(line_address);
             if (access_perm == AccessPermission_Read_Only ||
                 access_perm == AccessPermission_Read_Write) {
-                m_abs_cntrl_vec[i]->functionalRead(line_address, pkt);
-                return true;
+                cntrls[i]->functionalRead(line_address, pkt);
+                read = true;
+                break;
             }
         }
     }
 
-    return false;
+    Time end;
+    end.setTimer();
+
+    std::unique_lock<std::mutex> lock = lockShared();
+    m_functional_reads++;
+    m_functional_host_seconds += end - start;
+
+    return read;
 }
 
 // The function searches through all the buffers that exist in different
@@ -431,27 +530,41 @@ RubySystem::functionalWrite(PacketPtr pkt)
     Address addr(pkt->getAddr());
     Address line_addr = line_address(addr);
     AccessPermission access_perm = AccessPermission_NotPresent;
-    int num_controllers = m_abs_cntrl_vec.size();
+
+    Time start;
+    start.setTimer();
 
     DPRINTF(RubySystem, "Functional Write request for %s\n",addr);
 
     uint32_t M5_VAR_USED num_functional_writes = 0;
 
-    for (unsigned int i = 0; i < num_controllers;++i) {
+    // messages in flight may carry the line whatever the permissions,
+    // so every controller's buffers are written
+    for (unsigned int i = 0; i < m_abs_cntrl_vec.size(); ++i) {
         num_functional_writes +=
             m_abs_cntrl_vec[i]->functionalWriteBuffers(pkt);
+    }
 
-        access_perm = m_abs_cntrl_vec[i]->getAccessPermission(line_addr);
+    vector<AbstractController *> cntrls = getLineHolders(line_addr);
+    for (unsigned int i = 0; i < cntrls.size(); ++i) {
+        access_perm = cntrls[i]->getAccessPermission(line_addr);
         if (access_perm != AccessPermission_Invalid &&
             access_perm != AccessPermission_NotPresent) {
             num_functional_writes +=
-                m_abs_cntrl_vec[i]->functionalWrite(line_addr, pkt);
+                cntrls[i]->functionalWrite(line_addr, pkt);
         }
     }
 
     num_functional_writes += m_network->functionalWrite(pkt);
     DPRINTF(RubySystem, "Messages written = %u\n", num_functional_writes);
 
+    Time end;
+    end.setTimer();
+
+    std::unique_lock<std::mutex> lock = lockShared();
+    m_functional_writes++;
+    m_functional_host_seconds += end - start;
+
     return true;
 }
 
@@ -35,8 +35,13 @@
 #ifndef __MEM_RUBY_SYSTEM_SYSTEM_HH__
 #define __MEM_RUBY_SYSTEM_SYSTEM_HH__
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "base/callback.hh"
 #include "base/output.hh"
+#include "base/statistics.hh"
 #include "mem/ruby/profiler/Profiler.hh"
 #include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
@@ -88,7 +93,7 @@ class RubySystem : public ClockedObject
         return m_profiler;
     }
 
-    void regStats() { m_profiler->regStats(name()); }
+    void regStats();
     void collateStats() { m_profiler->collateStats(); }
     void resetStats();
 
@@ -102,6 +107,21 @@ class RubySystem : public ClockedObject
     void registerNetwork(Network*);
     void registerAbstractController(AbstractController*);
 
+    /**
+     * Record the permissions a controller holds a line with before and
+     * after a transition for it. Functional accesses only consult the
+     * controllers that hold the line, plus the directories, so the index
+     * only changes when a controller gains or loses the line.
+     */
+    void
+    updateLineHolder(AbstractController *cntrl, const Address &addr,
+                     AccessPermission old_perm, AccessPermission new_perm)
+    {
+        bool holds = holdsLine(new_perm);
+        if (holds != holdsLine(old_perm))
+            setLineHolder(cntrl, addr, holds);
+    }
+
     bool eventQueueEmpty() { return eventq->empty(); }
     void enqueueRubyEvent(Tick tick)
     {
@@ -120,6 +140,25 @@ class RubySystem : public ClockedObject
     void writeCompressedTrace(uint8_t *raw_data, std::string file,
                               uint64 uncompressed_trace_size);
 
+    static bool
+    holdsLine(AccessPermission perm)
+    {
+        return perm != AccessPermission_Invalid &&
+            perm != AccessPermission_NotPresent;
+    }
+
+    // Add a controller to the holders of a line, or remove it
+    void setLineHolder(AbstractController *cntrl, const Address &addr,
+                       bool holds);
+
+    // The controllers that may hold a line with a permission other
+    // than Invalid or NotPresent
+    std::vector<AbstractController *> getLineHolders(const Address &line);
+
+    // Lock the line holder index and the functional access stats. Only
+    // needed when several event queues run in parallel.
+    std::unique_lock<std::mutex> lockShared();
+
   private:
     // configuration parameters
     static int m_random_seed;
@@ -136,6 +175,21 @@ class RubySystem : public ClockedObject
     Network* m_network;
     std::vector<AbstractController *> m_abs_cntrl_vec;
 
+    // Directories own the lines no transition has touched yet, so
+    // they are always consulted rather than indexed
+    std::vector<AbstractController *> m_dir_cntrl_vec;
+
+    // The other controllers holding each line with a permission other
+    // than Invalid or NotPresent, as of their last transition for it
+    std::unordered_map<Addr, std::vector<AbstractController *>>
+        m_line_holders;
+    std::mutex m_shared_mutex;
+
+    Stats::Scalar m_functional_reads;
+    Stats::Scalar m_functional_writes;
+    Stats::Value m_functional_host_time;
+    double m_functional_host_seconds;
+
   public:
     Profiler* m_profiler;
     CacheRecorder* m_cache_recorder;
@@ -42,6 +42,7 @@
  *          Andreas Hansson
  */
 
+#include <cstring>
 #include <string>
 
 #include "arch/isa_traits.hh"
@@ -215,3 +216,71 @@ SETranslatingPortProxy::readString(std::string &str, Addr addr) const
         fatal("readString(0x%x, ...) failed", addr);
 }
 
+
+bool
+SETranslatingPortProxy::tryReadString(char *str, Addr addr, int max_len) const
+{
+    assert(max_len > 0);
+    int len = 0;
+
+    // Copy a page at a time rather than a byte at a time. Any page that
+    // translates is mapped in its entirety, so reading past the
+    // terminator within it is harmless.
+    for (ChunkGenerator gen(addr, max_len - 1, PageBytes);
+         !gen.done(); gen.next()) {
+        Addr paddr;
+
+        if (!pTable->translate(gen.addr(), paddr))
+            return false;
+
+        PortProxy::readBlob(paddr, (uint8_t *)str + len, gen.size());
+        if (memchr(str + len, '\0', gen.size()))
+            return true;
+        len += gen.size();
+    }
+
+    str[len] = '\0';
+    return true;
+}
+
+void
+SETranslatingPortProxy::readString(char *str, Addr addr, int max_len) const
+{
+    if (!tryReadString(str, addr, max_len))
+        fatal("readString(0x%x, ...) failed", addr);
+}
+
+bool
+SETranslatingPortProxy::tryReadWords(Addr addr, uint64_t *words, int count,
+                                     int word_size) const
+{
+    assert(word_size == sizeof(uint32_t) || word_size == sizeof(uint64_t));
+
+    // The packed guest words never take more room than the widened host
+    // ones, so read them straight into the destination.
+    if (!tryReadBlob(addr, (uint8_t *)words, count * word_size))
+        return false;
+
+    if (word_size == sizeof(uint64_t)) {
+        for (int i = 0; i < count; i++)
+            words[i] = gtoh(words[i]);
+    } else {
+        // Widen from the back so that no packed word is overwritten
+        // before it has been converted.
+        for (int i = count - 1; i >= 0; i--) {
+            uint32_t word;
+            memcpy(&word, (uint8_t *)words + i * word_size, word_size);
+            words[i] = gtoh(word);
+        }
+    }
+
+    return true;
+}
+
+void
+SETranslatingPortProxy::readWords(Addr addr, uint64_t *words, int count,
+                                  int word_size) const
+{
+    if (!tryReadWords(addr, words, count, word_size))
+        fatal("readWords(0x%x, ...) failed", addr);
+}
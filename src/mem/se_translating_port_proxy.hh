@@ -89,12 +89,34 @@ class SETranslatingPortProxy : public PortProxy
     bool tryWriteString(Addr addr, const char *str) const;
     bool tryReadString(std::string &str, Addr addr) const;
 
+    /**
+     * Read a NUL-terminated string into caller-provided storage of
+     * max_len bytes. The result is always terminated; strings longer
+     * than max_len - 1 characters are cut short.
+     *
+     * @return false if a page is unmapped before the terminator.
+     */
+    bool tryReadString(char *str, Addr addr, int max_len) const;
+
+    /**
+     * Read count consecutive target words of word_size (4 or 8) bytes
+     * each, converting them to host order and zero-extending them into
+     * words. This matches the layout of guest structures made up only
+     * of pointers and size_t fields, whose width depends on the ABI of
+     * the simulated process.
+     */
+    bool tryReadWords(Addr addr, uint64_t *words, int count,
+                      int word_size) const;
+
     virtual void readBlob(Addr addr, uint8_t *p, int size) const;
     virtual void writeBlob(Addr addr, const uint8_t *p, int size) const;
     virtual void memsetBlob(Addr addr, uint8_t val, int size) const;
 
     void writeString(Addr addr, const char *str) const;
     void readString(std::string &str, Addr addr) const;
+    void readString(char *str, Addr addr, int max_len) const;
+    void readWords(Addr addr, uint64_t *words, int count,
+                   int word_size) const;
 };
 
 #endif // __MEM_SE_TRANSLATING_PORT_PROXY_HH__
@@ -42,10 +42,12 @@
  *          Andreas Hansson
  */
 
+#include "base/intmath.hh"
 #include "base/random.hh"
 #include "mem/simple_mem.hh"
 #include "debug/Drain.hh"
 #include "debug/SimpleMem.hh"
+#include "sim/system.hh"
 
 using namespace std;
 
@@ -128,6 +130,9 @@ SimpleMemory::recvTimingReq(PacketPtr pkt)
     // @todo someone should pay for this
     pkt->headerDelay = pkt->payloadDelay = 0;
 
+    // extra delay for the lines of a DMA burst that follow the first
+    Tick burst_delay = 0;
+
     // update the release time according to the bandwidth limit, and
     // do so with respect to the time it takes to finish this request
     // rather than long term as it is the short term data rate that is
@@ -147,6 +152,15 @@ SimpleMemory::recvTimingReq(PacketPtr pkt)
         if (duration != 0) {
             if (latency == 0)
               duration = 0;
+
+            // the lines of a burst stream out one after the other, and
+            // the response leaves with the last one
+            if (duration != 0 && pkt->req->isDmaBurst() && system()) {
+                unsigned line_size = system()->cacheLineSize();
+                unsigned lines = divCeil(pkt->getSize(), line_size);
+                burst_delay = (lines - 1) * line_size * bandwidth;
+            }
+
             DPRINTF(SimpleMem, "schedule(event, curTick() + duration %lu\n", duration);
             schedule(releaseEvent, curTick() + duration);
             isBusy = true;
@@ -165,7 +179,8 @@ SimpleMemory::recvTimingReq(PacketPtr pkt)
         // to keep things simple (and in order), we put the packet at
         // the end even if the latency suggests it should be sent
         // before the packet(s) before it
-        packetQueue.emplace_back(DeferredPacket(pkt, curTick() + getLatency()));
+        packetQueue.emplace_back(DeferredPacket(pkt, curTick() + getLatency() +
+                                                burst_delay));
         if (!retryResp && !dequeueEvent.scheduled())
         {
             DPRINTF(SimpleMem, "needResponse: schedule(event, packetQueue.back().tick %lu \n", packetQueue.back().tick);
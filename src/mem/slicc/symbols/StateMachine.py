@@ -1200,6 +1200,11 @@ if (result == TransitionResult_Valid) {
         else:
             code('setState(addr, next_state);')
             code('setAccessPermission(addr, next_state);')
+        code('''
+g_system_ptr->updateLineHolder(this, addr,
+                               ${ident}_State_to_permission(state),
+                               ${ident}_State_to_permission(next_state));
+''')
 
         code('''
 } else if (result == TransitionResult_ResourceStall) {
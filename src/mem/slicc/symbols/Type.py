@@ -241,17 +241,20 @@ $klass ${{self.c_ident}}$parent
         if not self.isGlobal:
             code('${{self.c_ident}}(const ${{self.c_ident}}&other)')
 
-            # Call superclass constructor
+            # Call superclass constructor and copy construct the
+            # members, rather than default constructing and then
+            # assigning them, as messages are copied for every
+            # destination they are sent to
+            inits = []
             if "interface" in self:
-                code('    : ${{self["interface"]}}(other)')
-
-            code('{')
-            code.indent()
-
+                inits.append('%s(other)' % self["interface"])
             for dm in self.data_members.values():
-                code('m_${{dm.ident}} = other.m_${{dm.ident}};')
+                inits.append('m_%s(other.m_%s)' % (dm.ident, dm.ident))
 
-            code.dedent()
+            if inits:
+                code('    : ' + ',\n      '.join(inits))
+
+            code('{')
             code('}')
 
         # ******** Full init constructor ********
@@ -288,7 +291,7 @@ $klass ${{self.c_ident}}$parent
 MsgPtr
 clone() const
 {
-     return std::shared_ptr<Message>(new ${{self.c_ident}}(*this));
+     return allocateMessage<${{self.c_ident}}>(*this);
 }
 ''')
         else:
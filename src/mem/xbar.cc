@@ -47,6 +47,8 @@
  * Definition of a crossbar object.
  */
 
+#include <algorithm>
+
 #include "base/misc.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
@@ -79,6 +81,24 @@ BaseXBar::~BaseXBar()
 void
 BaseXBar::init()
 {
+    // Anything passing through the crossbar is delayed by at least the
+    // shorter of the request and response paths, so that is how far
+    // apart the event queues of its neighbours may run.
+    Tick latency = clockPeriod() *
+        std::min(frontendLatency + forwardLatency, responseLatency);
+
+    for (const auto& p: slavePorts) {
+        if (p->isConnected())
+            registerLookahead(p->getMasterPort().getOwner().eventQueue(),
+                              eventQueue(), latency);
+    }
+
+    for (const auto& p: masterPorts) {
+        if (p->isConnected())
+            registerLookahead(eventQueue(),
+                              p->getSlavePort().getOwner().eventQueue(),
+                              latency);
+    }
 }
 
 BaseMasterPort &
@@ -468,6 +468,10 @@ class BaseXBar : public MemObject
     BaseSlavePort& getSlavePort(const std::string& if_name,
                                 PortID idx = InvalidPortID);
 
+    /** The ports towards the slaves, to look at what lies behind. */
+    const std::vector<MasterPort*>& getMasterPorts() const
+    { return masterPorts; }
+
     virtual unsigned int drain(DrainManager *dm) = 0;
 
     virtual void regStats();
@@ -85,6 +85,9 @@ def parse_options():
     option("--stats-db-file", metavar="FILE", default="",
         help = "Sets the output database file for statistics [Default: \
             %default]")
+    option("--stats-binary-file", metavar="FILE", default="",
+        help="Also write statistics in binary form to FILE, see " \
+            "util/stats/binary.py [Default: %default]")
 
     # Configuration Options
     group("Configuration Options")
@@ -321,6 +324,9 @@ def main(*args):
     if options.stats_file:
         stats.initText(options.stats_file)
 
+    if options.stats_binary_file:
+        stats.initBinary(options.stats_binary_file)
+
     # Check that at least one stats output format is enabled
     if not stats.stats_output_enabled():
         warn("Unable to output statistics.")
@@ -112,6 +112,12 @@ def initText(filename, desc=True):
     global STATS_OUTPUT_ENABLED
     STATS_OUTPUT_ENABLED = True
 
+def initBinary(filename):
+    output = internal.stats.initBinary(filename)
+    outputList.append(output)
+    global STATS_OUTPUT_ENABLED
+    STATS_OUTPUT_ENABLED = True
+
 def initSimStats():
     internal.stats.initSimStats()
     internal.stats.registerPythonStatsHandlers()
@@ -151,6 +157,8 @@ names = []
 stats_dict = {}
 stats_list = []
 raw_stats_list = []
+stats_by_id = {}
+stats_order = {}
 def enable():
     '''Enable the statistics package.  Before the statistics package is
     enabled, all statistics must be created and initialized and once
@@ -184,8 +192,10 @@ def enable():
         return v1 < v2
 
     stats_list.sort(less)
-    for stat in stats_list:
+    for i,stat in enumerate(stats_list):
         stats_dict[stat.name] = stat
+        stats_by_id[stat.id] = stat
+        stats_order[stat.id] = i
         stat.enable()
 
     internal.stats.enable();
@@ -197,9 +207,71 @@ def prepare():
     for stat in stats_list:
         stat.prepare()
 
+# Default filter applied to every dump, see setDumpFilter().
+dump_changed_only = False
+dump_include = []
+
+# Once a dump has been filtered, every later dump goes through the filter
+# too so that "changed" always means changed since the previous dump.
+dump_filtering = False
+
+def setDumpFilter(changed_only=False, include=[]):
+    '''Limit what every stats dump emits.
+
+    Args:
+      changed_only: Only emit stats whose values changed since the
+        previous dump.
+      include: Only emit stats whose names match one of these glob
+        patterns, e.g. "system.cpu*.dcache.*". Empty emits every stat.
+    '''
+    global dump_changed_only, dump_include
+    dump_changed_only = changed_only
+    dump_include = list(include)
+
+def parseDumpDesc(desc):
+    '''Split dump options off a stats dump description.
+
+    A description, such as the one passed to the DUMP_STATS ioctl, is a
+    ';' separated list. The field "changed" asks for a delta dump and a
+    field "include=GLOB[,GLOB...]" restricts the dump to matching stats;
+    all other fields make up the description itself. For example
+    "kernel2;changed;include=system.acc*" yields
+    ("kernel2", True, ["system.acc*"]).
+
+    Returns:
+      A (desc, changed_only, include) tuple. changed_only and include
+      are None when the description doesn't set them.
+    '''
+    changed_only = None
+    include = None
+    fields = []
+    for field in desc.split(';'):
+        if field == 'changed':
+            changed_only = True
+        elif field.startswith('include='):
+            include = [ glob for glob in field[len('include='):].split(',')
+                        if glob ]
+        else:
+            fields.append(field)
+    return ';'.join(fields), changed_only, include
+
+def selectStats(changed_only, include):
+    '''The stats a dump with the given filter emits, in dump order.'''
+    ids = internal.stats.selectStats(changed_only, include)
+    ids = sorted(ids, key=stats_order.__getitem__)
+    return [ stats_by_id[id] for id in ids ]
+
 lastDump = 0
-def dump(stats_desc=""):
-    '''Dump all statistics data to the registered outputs'''
+def dump(stats_desc="", changed_only=None, include=None):
+    '''Dump all statistics data to the registered outputs
+
+    Args:
+      stats_desc: Description of the dump passed on to the outputs.
+      changed_only: Only dump stats that changed since the previous
+        dump. Defaults to the setting from setDumpFilter().
+      include: Glob patterns of the stats to dump. Defaults to the
+        setting from setDumpFilter().
+    '''
     if not STATS_OUTPUT_ENABLED:
         return
 
@@ -215,10 +287,22 @@ def dump(stats_desc=""):
 
     prepare()
 
+    if changed_only is None:
+        changed_only = dump_changed_only
+    if include is None:
+        include = dump_include
+
+    global dump_filtering
+    dump_filtering = dump_filtering or changed_only or bool(include)
+    if dump_filtering:
+        dump_stats = selectStats(changed_only, include)
+    else:
+        dump_stats = stats_list
+
     for output in outputList:
         if output.valid():
             output.begin(stats_desc)
-            for stat in stats_list:
+            for stat in dump_stats:
                 output.visit(stat)
             output.end()
 
@@ -238,6 +322,15 @@ def reset():
         stat.reset()
 
     internal.stats.processResetQueue()
+    internal.stats.resetEventProfile()
+
+def eventProfile():
+    '''Host time spent on each kind of event since the last reset, as a
+    list of (name, description, count, host seconds) tuples with the most
+    host time first. Empty unless Root.event_profile is set.'''
+
+    return [ (e.name, e.description, e.count, e.hostSeconds())
+             for e in internal.stats.eventProfile() ]
 
 flags = attrdict({
     'none'    : 0x0000,
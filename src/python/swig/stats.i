@@ -42,12 +42,15 @@ using std::ptrdiff_t;
 %include <stdint.i>
 
 %{
+#include "base/stats/binary.hh"
+#include "base/stats/dump_filter.hh"
 #include "base/stats/text.hh"
 #include "base/stats/types.hh"
 #include "base/callback.hh"
 #include "base/misc.hh"
 #include "base/statistics.hh"
 #include "sim/core.hh"
+#include "sim/event_profile.hh"
 #include "sim/stat_control.hh"
 #include "sim/stat_register.hh"
 
@@ -122,11 +125,27 @@ pythonReset()
 %include "base/stats/info.hh"
 %include "base/stats/output.hh"
 
+struct EventProfileEntry
+{
+    std::string name;
+    std::string description;
+    Counter count;
+    Counter timed;
+    double timedSeconds;
+
+    double hostSeconds() const;
+};
+
+std::vector<EventProfileEntry> eventProfile();
+void resetEventProfile();
+
 namespace std {
 %template(list_info) list<Stats::Info *>;
 %template(vector_double) vector<double>;
+%template(vector_int) vector<int>;
 %template(vector_string) vector<string>;
 %template(vector_DistData) vector<Stats::DistData>;
+%template(vector_EventProfileEntry) vector<EventProfileEntry>;
 }
 
 namespace Stats {
@@ -143,6 +162,7 @@ template <class T> T cast_info(Info *info);
 
 void initSimStats();
 Output *initText(const std::string &filename, bool desc);
+Output *initBinary(const std::string &filename);
 
 void registerPythonStatsHandlers();
 
@@ -160,4 +180,7 @@ bool enabled();
 
 std::list<Info *> &statsList();
 
+std::vector<int> selectStats(bool changed_only,
+                             const std::vector<std::string> &include);
+
 } // namespace Stats
@@ -69,6 +69,26 @@ class Root(SimObject):
     # Needs to be set explicitly for a multi-eventq simulation.
     sim_quantum = Param.Tick(0, "simulation quantum")
 
+    # Let the queues skip ahead to the earliest pending event instead of
+    # meeting every quantum. If links between objects on different
+    # queues report their latencies, the smallest of them is used as the
+    # quantum when sim_quantum is unset or larger.
+    sim_quantum_adaptive = Param.Bool(False,
+        "synchronize the main event queues adaptively")
+
+    # Order pending events with a calendar queue rather than a sorted
+    # list. Worth it when many events are pending at distinct times.
+    calendar_event_queue = Param.Bool(False,
+        "use calendar queues for the main event queues")
+
+    # Profile the host time spent on each kind of event; the ranked
+    # profile goes to event_profile.txt and m5.stats.eventProfile().
+    event_profile = Param.Bool(False, "profile host time per event type")
+    event_profile_sample = Param.Unsigned(16,
+        "time about one in this many events of each type when profiling")
+    event_profile_by_name = Param.Bool(False,
+        "profile per event name rather than per event type (slower)")
+
     full_system = Param.Bool("if this is a full system simulation")
 
     # Time syncing prevents the simulation from running faster than real time.
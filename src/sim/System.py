@@ -33,6 +33,7 @@ from m5.defines import buildEnv
 from m5.params import *
 from m5.proxy import *
 
+from AcceleratorManager import *
 from DVFSHandler import *
 from SimpleMemory import *
 
@@ -68,6 +69,20 @@ class System(MemObject):
     mmap_using_noreserve = Param.Bool(False, "mmap the backing store " \
                                           "without reserving swap")
 
+    # Track the memory pages written between checkpoints, so that a
+    # checkpoint only stores the pages that changed since the previous
+    # one taken or restored, and restoring it layers them on top
+    incremental_checkpoints = Param.Bool(False, "Only checkpoint the " \
+                                         "memory written since the " \
+                                         "previous checkpoint")
+
+    # Store full memory images uncompressed and sparse rather than
+    # gzipped. Restoring such a checkpoint maps the image copy-on-write
+    # instead of reading it, so memory is only paged in as it is used
+    uncompressed_checkpoints = Param.Bool(False, "Store memory images " \
+                                          "uncompressed so that they can " \
+                                          "be mapped on restore")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
@@ -104,3 +119,7 @@ class System(MemObject):
     # Dynamic voltage and frequency handler for the system, disabled by default
     # Provide list of domains that need to be controlled by the handler
     dvfs_handler = DVFSHandler()
+
+    # Registry of the accelerator datapaths attached to this system
+    accel_manager = Param.AcceleratorManager(AcceleratorManager(),
+                                             "Accelerator registry")
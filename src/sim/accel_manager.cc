@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "aladdin/gem5/Gem5Datapath.h"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "base/trace.hh"
+#include "debug/Aladdin.hh"
+#include "mem/page_table.hh"
+#include "sim/accel_manager.hh"
+
+AcceleratorManager::AcceleratorManager(const Params *p)
+    : SimObject(p), _hugePageSize(p->huge_page_size),
+      numRegistered(0), numActive(0)
+{
+    fatal_if(_hugePageSize && !isPowerOf2(_hugePageSize),
+             "Accelerator huge page size %d is not a power of 2.",
+             _hugePageSize);
+}
+
+AcceleratorManager::~AcceleratorManager()
+{
+}
+
+const AcceleratorManager::AccelInstance &
+AcceleratorManager::instance(AccelHandle handle) const
+{
+    panic_if(handle < 0 || handle >= (AccelHandle)instances.size() ||
+             instances[handle].state == Unused,
+             "Invalid accelerator handle %d.\n", handle);
+    return instances[handle];
+}
+
+AcceleratorManager::AccelInstance &
+AcceleratorManager::instance(AccelHandle handle)
+{
+    panic_if(handle < 0 || handle >= (AccelHandle)instances.size() ||
+             instances[handle].state == Unused,
+             "Invalid accelerator handle %d.\n", handle);
+    return instances[handle];
+}
+
+AcceleratorManager::Design &
+AcceleratorManager::design(int id, const char *action)
+{
+    auto it = designs.find(id);
+    if (it == designs.end())
+        fatal("Unable to %s: No accelerator with id %#x.", action, id);
+    return it->second;
+}
+
+AcceleratorManager::AccelHandle
+AcceleratorManager::registerAccelerator(int id, Gem5Datapath *datapath,
+                                        const std::vector<int> &deps,
+                                        bool reports_completion)
+{
+    Design &d = designs[id];
+    if (d.instances.empty()) {
+        d.deps = deps;
+        d.reportsCompletion = reports_completion;
+    } else if (d.deps != deps) {
+        fatal("Unable to register accelerator: instances of accelerator "
+              "%#x have different dependencies.", id);
+    } else if (d.reportsCompletion != reports_completion) {
+        fatal("Unable to register accelerator: some instances of "
+              "accelerator %#x do not report their completion.", id);
+    }
+
+    AccelHandle handle;
+    if (freeHandles.empty()) {
+        handle = instances.size();
+        instances.emplace_back();
+    } else {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+
+    AccelInstance &inst = instances[handle];
+    inst.id = id;
+    inst.datapath = datapath;
+    inst.rangeTLB = dynamic_cast<AccelRangeTranslation *>(datapath);
+    inst.state = Idle;
+    inst.boundContext = AnyContext;
+
+    d.instances.push_back(handle);
+    numRegistered++;
+
+    DPRINTF(Aladdin, "Registered accelerator %d instance %d (handle %d)\n",
+            id, d.instances.size() - 1, handle);
+    return handle;
+}
+
+void
+AcceleratorManager::deregisterInstance(AccelHandle handle)
+{
+    AccelInstance &inst = instance(handle);
+    if (inst.state == Waiting)
+        fatal("Unable to deregister accelerator: accelerator %#x is waiting "
+              "on its dependencies.", inst.id);
+    // A datapath that leaves the system while running has finished its
+    // last invocation.
+    if (inst.state == Running)
+        acceleratorFinished(handle);
+
+    Design &d = design(inst.id, "deregister accelerator");
+    d.instances.erase(std::find(d.instances.begin(), d.instances.end(),
+                                handle));
+    if (d.instances.empty() && !d.outstanding)
+        designs.erase(inst.id);
+
+    DPRINTF(Aladdin, "Deregistered accelerator %d (handle %d)\n",
+            inst.id, handle);
+
+    inst = AccelInstance();
+    freeHandles.push_back(handle);
+    numRegistered--;
+}
+
+void
+AcceleratorManager::deregisterAccelerator(int id)
+{
+    Design &d = design(id, "deregister accelerator");
+    if (d.instances.size() != 1)
+        fatal("Unable to deregister accelerator: accelerator %#x has %d "
+              "instances, deregister them by handle.", id,
+              d.instances.size());
+    deregisterInstance(d.instances.front());
+}
+
+AcceleratorManager::AccelHandle
+AcceleratorManager::lookup(int id, int context_id)
+{
+    Design &d = design(id, "look up accelerator");
+    if (d.instances.size() == 1)
+        return d.instances.front();
+
+    if (context_id != AnyContext) {
+        for (auto handle : d.instances) {
+            if (instances[handle].boundContext == context_id)
+                return handle;
+        }
+    }
+
+    for (auto handle : d.instances) {
+        AccelInstance &inst = instances[handle];
+        if (inst.state == Idle && inst.boundContext == AnyContext) {
+            inst.boundContext = context_id;
+            DPRINTF(Aladdin, "Bound accelerator %d (handle %d) to context "
+                    "%d\n", id, handle, context_id);
+            return handle;
+        }
+    }
+
+    fatal("No free instance of accelerator %#x for context %d; all %d "
+          "instances are in use.", id, context_id, d.instances.size());
+}
+
+void
+AcceleratorManager::insertTranslation(AccelHandle handle, Addr vaddr,
+                                      Addr paddr, Addr size, Addr page_bytes)
+{
+    AccelInstance &inst = instance(handle);
+
+    // Record the region, merged with those it overlaps or touches.
+    Addr start = vaddr;
+    Addr end = vaddr + size;
+    auto it = inst.translated.upper_bound(start);
+    if (it != inst.translated.begin() && std::prev(it)->second >= start)
+        --it;
+    while (it != inst.translated.end() && it->first <= end) {
+        start = std::min(start, it->first);
+        end = std::max(end, it->second);
+        it = inst.translated.erase(it);
+    }
+    inst.translated[start] = end;
+
+    if (inst.rangeTLB) {
+        inst.rangeTLB->insertTLBRange(vaddr, paddr, size);
+        rangeTranslations++;
+        return;
+    }
+
+    for (Addr offset = 0; offset < size; offset += page_bytes) {
+        inst.datapath->insertTLBEntry(vaddr + offset, paddr + offset);
+        pageTranslations++;
+    }
+}
+
+void
+AcceleratorManager::refreshTranslations(PageTableBase *page_table, Addr vaddr,
+                                        Addr size, Addr page_bytes)
+{
+    Addr start = roundDown(vaddr, page_bytes);
+    Addr end = roundUp(vaddr + size, page_bytes);
+    for (AccelHandle handle = 0; handle < (AccelHandle)instances.size();
+         handle++) {
+        if (instances[handle].state == Unused)
+            continue;
+
+        // Collect the overlaps first, inserting them changes the map.
+        std::vector<std::pair<Addr, Addr>> stale;
+        for (auto &region : instances[handle].translated) {
+            if (region.first < end && region.second > start)
+                stale.emplace_back(std::max(region.first, start),
+                                   std::min(region.second, end));
+        }
+
+        for (auto &region : stale) {
+            // The region was moved onto contiguous pages as a whole.
+            Addr paddr;
+            if (!page_table->translate(region.first, paddr))
+                continue;
+            DPRINTF(Aladdin, "Refreshing translations of %#x-%#x in "
+                    "accelerator %d (handle %d)\n", region.first,
+                    region.second, instances[handle].id, handle);
+            insertTranslation(handle, region.first, paddr,
+                              region.second - region.first, page_bytes);
+        }
+    }
+}
+
+bool
+AcceleratorManager::dependenciesMet(const Design &d) const
+{
+    for (auto dep : d.deps) {
+        auto it = designs.find(dep);
+        if (it != designs.end() && &it->second != &d &&
+            it->second.reportsCompletion && it->second.outstanding > 0)
+            return false;
+    }
+    return true;
+}
+
+void
+AcceleratorManager::start(const PendingInvocation &inv)
+{
+    AccelInstance &inst = instance(inv.handle);
+    inst.state = Running;
+    inst.datapath->setFinishFlag(inv.finishFlag);
+    inst.datapath->setContextThreadIds(inv.contextId, inv.threadId);
+    inst.datapath->initializeDatapath(inv.delay);
+    DPRINTF(Aladdin, "Scheduling accelerator %d (handle %d)\n",
+            inst.id, inv.handle);
+}
+
+AcceleratorManager::AccelHandle
+AcceleratorManager::activate(int id, Addr finish_flag, int context_id,
+                             int thread_id, int delay)
+{
+    Design &d = design(id, "activate accelerator");
+    AccelHandle handle = lookup(id, context_id);
+    AccelInstance &inst = instances[handle];
+
+    if (inst.state == Waiting)
+        fatal("Unable to activate accelerator %#x: the previous invocation "
+              "is still waiting on its dependencies.", id);
+    // Datapaths are not required to report completion; invoking a running
+    // instance of a design that does not means its previous invocation
+    // has finished.
+    if (inst.state == Running) {
+        if (d.reportsCompletion)
+            fatal("Unable to activate accelerator %#x: the previous "
+                  "invocation has not finished.", id);
+        acceleratorFinished(handle);
+    }
+    if (d.instances.size() > 1)
+        inst.boundContext = context_id;
+
+    DPRINTF(Aladdin, "Activating accelerator id %d (handle %d)\n",
+            id, handle);
+
+    d.outstanding++;
+    numActive++;
+    invocations++;
+    if (numActive > 1)
+        concurrentInvocations++;
+
+    PendingInvocation inv = { handle, finish_flag, context_id, thread_id,
+                              delay };
+    if (dependenciesMet(d)) {
+        start(inv);
+    } else {
+        DPRINTF(Aladdin, "Accelerator %d waits for its dependencies\n", id);
+        inst.state = Waiting;
+        pending.push_back(inv);
+        dependencyStalls++;
+    }
+    return handle;
+}
+
+void
+AcceleratorManager::acceleratorFinished(AccelHandle handle)
+{
+    AccelInstance &inst = instance(handle);
+    if (inst.state != Running)
+        fatal("Accelerator %#x (handle %d) finished without running.",
+              inst.id, handle);
+
+    DPRINTF(Aladdin, "Accelerator %d (handle %d) finished\n",
+            inst.id, handle);
+
+    inst.state = Idle;
+    inst.boundContext = AnyContext;
+    Design &d = design(inst.id, "finish accelerator");
+    assert(d.outstanding > 0);
+    d.outstanding--;
+    numActive--;
+
+    // Starting an invocation does not change any outstanding count, so a
+    // single pass releases everything this completion unblocked.
+    auto it = pending.begin();
+    while (it != pending.end()) {
+        const Design &waiting =
+            design(instances[it->handle].id, "schedule accelerator");
+        if (dependenciesMet(waiting)) {
+            start(*it);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+AcceleratorManager::regStats()
+{
+    SimObject::regStats();
+
+    invocations
+        .name(name() + ".invocations")
+        .desc("Number of accelerator invocations")
+        ;
+
+    dependencyStalls
+        .name(name() + ".dependency_stalls")
+        .desc("Number of invocations delayed by unfinished dependencies")
+        ;
+
+    concurrentInvocations
+        .name(name() + ".concurrent_invocations")
+        .desc("Number of invocations started while another was active")
+        ;
+
+    rangeTranslations
+        .name(name() + ".range_translations")
+        .desc("Number of range entries inserted into accelerator TLBs")
+        ;
+
+    pageTranslations
+        .name(name() + ".page_translations")
+        .desc("Number of page entries inserted into accelerator TLBs")
+        ;
+}
+
+AcceleratorManager *
+AcceleratorManagerParams::create()
+{
+    return new AcceleratorManager(this);
+}
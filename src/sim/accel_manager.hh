@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __SIM_ACCEL_MANAGER_HH__
+#define __SIM_ACCEL_MANAGER_HH__
+
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "params/AcceleratorManager.hh"
+#include "sim/sim_object.hh"
+
+class Gem5Datapath;
+class PageTableBase;
+
+/**
+ * Interface for datapaths whose TLB can hold translations that cover more
+ * than one base page, such as huge pages or arbitrary contiguous ranges.
+ * Datapaths that do not implement it receive one entry per base page.
+ */
+class AccelRangeTranslation
+{
+  public:
+    virtual ~AccelRangeTranslation() {}
+
+    /**
+     * Insert a translation for a virtually and physically contiguous
+     * region.
+     */
+    virtual void insertTLBRange(Addr vaddr, Addr paddr, Addr size) = 0;
+};
+
+/**
+ * Central registry of the accelerator datapaths in a system.
+ *
+ * Every Gem5Datapath registers itself under an accelerator id (usually
+ * the ioctl request code the application uses to invoke it). Several
+ * datapaths may register under the same id; each one is an instance of
+ * that design, which lets different threads run the same accelerator
+ * concurrently. Every registration is identified by a handle that
+ * indexes straight into the instance table, so per-invocation lookups
+ * never search the registry.
+ *
+ * Each design carries the list of accelerator ids it depends on. An
+ * invocation does not start while any of those designs still has
+ * running or waiting invocations; it is queued instead and started when
+ * the last of them finishes. Only designs whose datapaths report their
+ * completion through acceleratorFinished() are waited on, since the
+ * invocations of any other design are never known to be done.
+ */
+class AcceleratorManager : public SimObject
+{
+  public:
+    typedef AcceleratorManagerParams Params;
+    AcceleratorManager(const Params *p);
+    ~AcceleratorManager();
+
+    /** Index of a registered datapath instance. */
+    typedef int AccelHandle;
+    static const AccelHandle InvalidAccelHandle = -1;
+
+    /** Context id used by callers that do not know the invoking context. */
+    static const int AnyContext = -1;
+
+    /**
+     * Register a datapath instance of the design with the given id.
+     *
+     * @param id Accelerator id of the design.
+     * @param datapath Datapath implementing this instance.
+     * @param deps Ids of the designs that must finish before an
+     *             invocation of this design may start.
+     * @param reports_completion True if the datapath calls
+     *             acceleratorFinished() when an invocation completes.
+     * @return Handle of the new instance.
+     */
+    AccelHandle registerAccelerator(int id, Gem5Datapath *datapath,
+                                    const std::vector<int> &deps,
+                                    bool reports_completion = false);
+
+    /** Remove a single instance from the registry. */
+    void deregisterInstance(AccelHandle handle);
+
+    /**
+     * Remove the instance registered under an id. Only valid while the
+     * design has a single instance; multi-instance designs must be
+     * deregistered by handle.
+     */
+    void deregisterAccelerator(int id);
+
+    /**
+     * Find the instance serving the given context, binding an idle one
+     * to it if the context does not have one yet. Designs with a single
+     * instance share it among all contexts.
+     */
+    AccelHandle lookup(int id, int context_id = AnyContext);
+
+    /** Get the datapath of an instance. */
+    Gem5Datapath *datapath(AccelHandle handle) const
+    {
+        return instance(handle).datapath;
+    }
+
+    /** Get the accelerator id an instance was registered under. */
+    int acceleratorId(AccelHandle handle) const
+    {
+        return instance(handle).id;
+    }
+
+    /**
+     * Insert the translation of a contiguous region into the TLB of an
+     * instance. The region is split into @p page_bytes entries unless the
+     * datapath accepts range entries.
+     */
+    void insertTranslation(AccelHandle handle, Addr vaddr, Addr paddr,
+                           Addr size, Addr page_bytes);
+
+    /**
+     * Insert the translations of a region again into every instance
+     * that was given any of its pages, after the region moved to other
+     * physical pages. The new translations replace the old ones.
+     */
+    void refreshTranslations(PageTableBase *page_table, Addr vaddr,
+                             Addr size, Addr page_bytes);
+
+    /**
+     * Size of the pages that back arrays mapped for accelerators, or 0
+     * to leave them on base pages.
+     */
+    Addr hugePageSize() const { return _hugePageSize; }
+
+    /**
+     * Invoke the design with the given id on behalf of a thread. The
+     * invocation starts after @p delay cycles, or as soon as the design's
+     * dependencies have finished if any are still outstanding.
+     *
+     * @return Handle of the instance executing the invocation.
+     */
+    AccelHandle activate(int id, Addr finish_flag, int context_id,
+                         int thread_id, int delay = 1);
+
+    /**
+     * Mark the invocation running on an instance as finished. This
+     * releases the instance for other contexts and starts any queued
+     * invocation whose dependencies are now satisfied. Datapaths that
+     * report completion call it when they set their finish flag.
+     */
+    void acceleratorFinished(AccelHandle handle);
+
+    /** Number of registered datapath instances. */
+    int numInstances() const { return numRegistered; }
+
+    /** Number of invocations started but not yet finished. */
+    int numActiveInvocations() const { return numActive; }
+
+    void regStats() override;
+
+  private:
+    enum InstanceState {
+        Unused,
+        Idle,
+        Waiting,
+        Running
+    };
+
+    struct AccelInstance
+    {
+        AccelInstance()
+            : id(0), datapath(nullptr), rangeTLB(nullptr), state(Unused),
+              boundContext(AnyContext)
+        {}
+
+        int id;
+        Gem5Datapath *datapath;
+        /** The datapath's range interface, if it implements one. */
+        AccelRangeTranslation *rangeTLB;
+        InstanceState state;
+        /** Context that mapped its arrays onto this instance. */
+        int boundContext;
+        /** Virtual regions inserted into the TLB, start to end. */
+        std::map<Addr, Addr> translated;
+    };
+
+    struct Design
+    {
+        Design() : outstanding(0), reportsCompletion(false) {}
+
+        std::vector<int> deps;
+        std::vector<AccelHandle> instances;
+        /** Invocations of this design that are waiting or running. */
+        unsigned outstanding;
+        /** The datapaths of this design call acceleratorFinished(). */
+        bool reportsCompletion;
+    };
+
+    /** An invocation held back by unfinished dependencies. */
+    struct PendingInvocation
+    {
+        AccelHandle handle;
+        Addr finishFlag;
+        int contextId;
+        int threadId;
+        int delay;
+    };
+
+    const AccelInstance &instance(AccelHandle handle) const;
+    AccelInstance &instance(AccelHandle handle);
+
+    Design &design(int id, const char *action);
+
+    /** Check whether every dependency of a design has finished. */
+    bool dependenciesMet(const Design &d) const;
+
+    /** Hand an invocation to its datapath. */
+    void start(const PendingInvocation &inv);
+
+    std::vector<AccelInstance> instances;
+    std::vector<AccelHandle> freeHandles;
+    std::unordered_map<int, Design> designs;
+    std::deque<PendingInvocation> pending;
+
+    const Addr _hugePageSize;
+
+    int numRegistered;
+    int numActive;
+
+    Stats::Scalar invocations;
+    Stats::Scalar dependencyStalls;
+    Stats::Scalar concurrentInvocations;
+    Stats::Scalar rangeTranslations;
+    Stats::Scalar pageTranslations;
+};
+
+#endif // __SIM_ACCEL_MANAGER_HH__
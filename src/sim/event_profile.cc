@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "sim/event_profile.hh"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <typeinfo>
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/output.hh"
+#include "base/time.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+
+using namespace std;
+
+EventProfile::EventProfile(unsigned sample_period, bool by_name)
+    : samplePeriod(max(sample_period, 1U)), byName(by_name), rng(0)
+{
+}
+
+EventProfileEntry &
+EventProfile::entry(const Event *event)
+{
+    if (byName) {
+        const string name = event->name();
+        EventProfileEntry &e = nameEntries[name];
+        if (e.name.empty()) {
+            e.name = name;
+            e.description = event->description();
+        }
+        return e;
+    }
+
+    const type_info &type = typeid(*event);
+    EventProfileEntry &e = typeEntries[type_index(type)];
+    if (e.name.empty()) {
+        int status;
+        char *name = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+        e.name = status == 0 ? name : type.name();
+        e.description = event->description();
+        free(name);
+    }
+    return e;
+}
+
+void
+EventProfile::process(Event *event)
+{
+    EventProfileEntry &e = entry(event);
+    e.count++;
+
+    if (--e.untilSample) {
+        event->process();
+        return;
+    }
+    // gaps of 1 to 2 * samplePeriod - 1 events, samplePeriod on average
+    e.untilSample = rng.random<unsigned>(1, 2 * samplePeriod - 1);
+
+    Time start;
+    start.setTimer();
+    event->process();
+    Time end;
+    end.setTimer();
+
+    e.timed++;
+    e.timedSeconds += end - start;
+}
+
+void
+EventProfile::merge(map<string, EventProfileEntry> &entries) const
+{
+    vector<const EventProfileEntry *> mine;
+    for (const auto& i : typeEntries)
+        mine.push_back(&i.second);
+    for (const auto& i : nameEntries)
+        mine.push_back(&i.second);
+
+    for (size_t i = 0; i < mine.size(); ++i) {
+        EventProfileEntry &e = entries[mine[i]->name];
+        if (e.name.empty()) {
+            e.name = mine[i]->name;
+            e.description = mine[i]->description;
+        }
+        e.count += mine[i]->count;
+        e.timed += mine[i]->timed;
+        e.timedSeconds += mine[i]->timedSeconds;
+    }
+}
+
+void
+EventProfile::reset()
+{
+    typeEntries.clear();
+    nameEntries.clear();
+}
+
+namespace {
+
+class EventProfileCallback : public Callback
+{
+  public:
+    void
+    process()
+    {
+        ostream *os = simout.create("event_profile.txt");
+        dumpEventProfile(*os);
+        simout.close(os);
+    }
+};
+
+bool
+hostSecondsGreater(const EventProfileEntry &a, const EventProfileEntry &b)
+{
+    return a.hostSeconds() > b.hostSeconds();
+}
+
+} // anonymous namespace
+
+void
+enableEventProfile(unsigned sample_period, bool by_name)
+{
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        mainEventQueue[i]->enableProfile(sample_period, by_name);
+
+    static bool registered = false;
+    if (!registered) {
+        registerExitCallback(new EventProfileCallback);
+        registered = true;
+    }
+}
+
+vector<EventProfileEntry>
+eventProfile()
+{
+    map<string, EventProfileEntry> merged;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        const EventProfile *profile = mainEventQueue[i]->getProfile();
+        if (profile)
+            profile->merge(merged);
+    }
+
+    vector<EventProfileEntry> entries;
+    for (const auto& i : merged)
+        entries.push_back(i.second);
+    stable_sort(entries.begin(), entries.end(), hostSecondsGreater);
+
+    return entries;
+}
+
+void
+resetEventProfile()
+{
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        EventProfile *profile = mainEventQueue[i]->getProfile();
+        if (profile)
+            profile->reset();
+    }
+}
+
+void
+dumpEventProfile(ostream &os)
+{
+    vector<EventProfileEntry> entries = eventProfile();
+
+    double total = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+        total += entries[i].hostSeconds();
+
+    ccprintf(os, "%10s %7s %14s %10s  %s\n",
+             "host_secs", "share", "events", "ns/event", "event");
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const EventProfileEntry &e = entries[i];
+        double secs = e.hostSeconds();
+        ccprintf(os, "%10.3f %6.2f%% %14d %10.1f  %s (%s)\n",
+                 secs, total > 0 ? 100 * secs / total : 0, e.count,
+                 e.count ? 1e9 * secs / e.count : 0, e.name,
+                 e.description);
+    }
+}
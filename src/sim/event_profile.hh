@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __SIM_EVENT_PROFILE_HH__
+#define __SIM_EVENT_PROFILE_HH__
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "base/random.hh"
+#include "base/types.hh"
+
+class Event;
+
+/**
+ * Aggregate profile of one kind of event.
+ */
+struct EventProfileEntry
+{
+    //! C++ class of the events, or their name when profiling by name.
+    std::string name;
+    //! Event::description() of the first of the events.
+    std::string description;
+    //! Number of events processed.
+    Counter count;
+    //! Number of those whose processing was timed.
+    Counter timed;
+    //! Host seconds spent processing the timed events.
+    double timedSeconds;
+    //! Events of this kind left until the next timed one.
+    unsigned untilSample;
+
+    EventProfileEntry()
+        : count(0), timed(0), timedSeconds(0), untilSample(1)
+    {}
+
+    //! Estimated host seconds spent processing all of the events.
+    double
+    hostSeconds() const
+    {
+        return timed ? timedSeconds * count / timed : 0;
+    }
+};
+
+/**
+ * Profile of the host time an event queue spends processing events,
+ * kept by EventQueue::serviceOne() once enabled. Events are grouped by
+ * C++ class, or optionally by name(), which tells SimObjects apart but
+ * builds a string for every event. Every event is counted, but reading
+ * the clock costs about as much as a small event, so only one in about
+ * samplePeriod events of each kind is timed and the host time of the
+ * others is extrapolated. The first event of each kind is always timed,
+ * so rare but expensive events still show up, and the gaps between
+ * timed events are random so that they do not beat with events that
+ * recur every cycle.
+ */
+class EventProfile
+{
+  private:
+    const unsigned samplePeriod;
+    const bool byName;
+    //! Draws the sampling gaps, separate from the simulated system's
+    //! generator so profiling does not change the simulation.
+    Random rng;
+
+    std::unordered_map<std::type_index, EventProfileEntry> typeEntries;
+    std::unordered_map<std::string, EventProfileEntry> nameEntries;
+
+    EventProfileEntry &entry(const Event *event);
+
+  public:
+    EventProfile(unsigned sample_period, bool by_name);
+
+    //! Process an event and account for it.
+    void process(Event *event);
+
+    //! Add the entries of this profile to entries, keyed by name.
+    void merge(std::map<std::string, EventProfileEntry> &entries) const;
+
+    void reset();
+};
+
+/**
+ * Profile the events processed on all main event queues, timing one in
+ * every sample_period events. The profile is written to
+ * event_profile.txt in the output directory on exit.
+ */
+void enableEventProfile(unsigned sample_period, bool by_name);
+
+//! Profile of all main event queues, most host time first.
+std::vector<EventProfileEntry> eventProfile();
+
+void resetEventProfile();
+
+//! Write eventProfile() as a table.
+void dumpEventProfile(std::ostream &os);
+
+#endif // __SIM_EVENT_PROFILE_HH__
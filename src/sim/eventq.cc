@@ -32,6 +32,7 @@
  *          Steve Raasch
  */
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <string>
@@ -39,15 +40,20 @@
 
 #include "base/hashmap.hh"
 #include "base/misc.hh"
+#include "base/statistics.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
 #include "debug/Config.hh"
 #include "sim/core.hh"
+#include "sim/event_profile.hh"
+#include "sim/eventq_calendar.hh"
 #include "sim/eventq_impl.hh"
 
 using namespace std;
 
 Tick simQuantum = 0;
+Tick simLookahead = MaxTick;
+bool simQuantumAdaptive = false;
 
 //
 // Main Event Queues
@@ -117,6 +123,12 @@ Event::insertBefore(Event *event, Event *curr)
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        calendar->insert(event);
+        head = calendar->front();
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
@@ -176,6 +188,12 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        calendar->remove(event);
+        head = calendar->front();
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -208,7 +226,10 @@ EventQueue::serviceOne()
     Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
-    if (next) {
+    if (calendar) {
+        calendar->popFront();
+        head = calendar->front();
+    } else if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
 
@@ -225,7 +246,10 @@ EventQueue::serviceOne()
         // forward current cycle to the time when this event occurs.
         setCurTick(event->when());
 
-        event->process();
+        if (profile)
+            profile->process(event);
+        else
+            event->process();
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::AutoDelete) ||
                    !event->flags.isSet(Event::IsMainQueue)); // would be silly
@@ -293,11 +317,12 @@ void
 EventQueue::serialize(ostream &os)
 {
     std::list<Event *> eventPtrs;
+    std::vector<Event *> bins;
+    getBins(bins);
 
     int numEvents = 0;
-    Event *nextBin = head;
-    while (nextBin) {
-        Event *nextInBin = nextBin;
+    for (size_t i = 0; i < bins.size(); ++i) {
+        Event *nextInBin = bins[i];
 
         while (nextInBin) {
             if (nextInBin->flags.isSet(Event::AutoSerialize)) {
@@ -307,8 +332,6 @@ EventQueue::serialize(ostream &os)
             }
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     SERIALIZE_SCALAR(numEvents);
@@ -346,15 +369,14 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
-            Event *nextInBin = nextBin;
+        std::vector<Event *> bins;
+        getBins(bins);
+        for (size_t i = 0; i < bins.size(); ++i) {
+            Event *nextInBin = bins[i];
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -369,9 +391,10 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
-    Event *nextBin = head;
-    while (nextBin) {
-        Event *nextInBin = nextBin;
+    std::vector<Event *> bins;
+    getBins(bins);
+    for (size_t i = 0; i < bins.size(); ++i) {
+        Event *nextInBin = bins[i];
         while (nextInBin) {
             if (nextInBin->when() < time) {
                 cprintf("time goes backwards!");
@@ -396,8 +419,6 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
@@ -406,11 +427,62 @@ EventQueue::debugVerify() const
 Event*
 EventQueue::replaceHead(Event* s)
 {
+    if (calendar) {
+        // Hand out and take back events as a sorted list of bins so
+        // that callers don't depend on the ordering in use.
+        Event *t = calendar->extract();
+        calendar->insertBins(s);
+        head = calendar->front();
+        return t;
+    }
+
     Event* t = head;
     head = s;
     return t;
 }
 
+void
+EventQueue::getBins(std::vector<Event *> &bins) const
+{
+    if (calendar) {
+        calendar->getBins(bins);
+        return;
+    }
+
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        bins.push_back(bin);
+}
+
+void
+EventQueue::useCalendar(bool enable)
+{
+    if (enable == usingCalendar())
+        return;
+
+    Event *bins = replaceHead(NULL);
+    if (enable) {
+        calendar = new EventCalendar;
+    } else {
+        delete calendar;
+        calendar = NULL;
+    }
+    replaceHead(bins);
+}
+
+void
+registerLookahead(EventQueue *from, EventQueue *to, Tick latency)
+{
+    if (from != to)
+        simLookahead = std::min(simLookahead, latency);
+}
+
+void
+EventQueue::enableProfile(unsigned sample_period, bool by_name)
+{
+    delete profile;
+    profile = new EventProfile(sample_period, by_name);
+}
+
 void
 dumpMainQueue()
 {
@@ -459,29 +531,116 @@ Event::dump() const
     }
 }
 
+struct EventQueue::SyncStats
+{
+    Stats::Scalar events;
+    Stats::Histogram eventsPerQuantum;
+    Stats::Scalar barriers;
+    Stats::Scalar barrierWaitTime;
+};
+
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), calendar(NULL), profile(NULL),
+      async_queue(NULL), syncStats(NULL)
+{
+}
+
+EventQueue::~EventQueue()
 {
+    delete calendar;
+    delete profile;
+    delete syncStats;
 }
 
 void
 EventQueue::asyncInsert(Event *event)
 {
-    async_queue_mutex.lock();
-    async_queue.push_back(event);
-    async_queue_mutex.unlock();
+    Event *top = async_queue.load(std::memory_order_relaxed);
+    do {
+        event->nextBin = top;
+    } while (!async_queue.compare_exchange_weak(top, event,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
 }
 
 void
 EventQueue::handleAsyncInsertions()
 {
     assert(this == curEventQueue());
-    async_queue_mutex.lock();
 
-    while (!async_queue.empty()) {
-        insert(async_queue.front());
-        async_queue.pop_front();
+    Event *pending = async_queue.exchange(NULL, std::memory_order_acquire);
+
+    // The stack holds the newest event first; reverse it so that events
+    // with the same time and priority keep their insertion order.
+    Event *oldest = NULL;
+    unsigned count = 0;
+    while (pending) {
+        Event *next = pending->nextBin;
+        pending->nextBin = oldest;
+        oldest = pending;
+        pending = next;
+        count++;
+    }
+
+    while (oldest) {
+        Event *next = oldest->nextBin;
+        insert(oldest);
+        oldest = next;
+    }
+
+    if (syncStats) {
+        syncStats->events += count;
+        syncStats->eventsPerQuantum.sample(count);
+    }
+}
+
+Tick
+EventQueue::nextPendingTick() const
+{
+    Tick when = empty() ? MaxTick : nextTick();
+
+    Event *event = async_queue.load(std::memory_order_acquire);
+    for (; event; event = event->nextBin)
+        when = std::min(when, event->when());
+
+    return when;
+}
+
+void
+EventQueue::barrierWaited(double seconds)
+{
+    if (syncStats) {
+        syncStats->barriers++;
+        syncStats->barrierWaitTime += seconds;
     }
+}
 
-    async_queue_mutex.unlock();
+void
+EventQueue::regStats(const string &name)
+{
+    assert(!syncStats);
+    syncStats = new SyncStats;
+
+    syncStats->events
+        .name(name + ".async_events")
+        .desc("Number of events scheduled on this queue by other threads")
+        ;
+
+    syncStats->eventsPerQuantum
+        .init(16)
+        .name(name + ".async_events_per_quantum")
+        .desc("Number of events scheduled on this queue by other threads "
+              "per simulation quantum")
+        ;
+
+    syncStats->barriers
+        .name(name + ".barriers")
+        .desc("Number of quantum barriers this queue's thread passed")
+        ;
+
+    syncStats->barrierWaitTime
+        .name(name + ".barrier_wait_time")
+        .desc("Host seconds this queue's thread spent waiting for the "
+              "other threads at quantum barriers")
+        ;
 }
@@ -39,12 +39,14 @@
 #define __SIM_EVENTQ_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <iosfwd>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "base/flags.hh"
 #include "base/misc.hh"
@@ -52,6 +54,8 @@
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
 
+class EventCalendar;
+class EventProfile;
 class EventQueue;       // forward declaration
 class BaseGlobalEvent;
 
@@ -62,6 +66,17 @@ class BaseGlobalEvent;
 //! Queue B should be at least simQuantum ticks away in future.
 extern Tick simQuantum;
 
+//! Smallest latency of any link between objects on different main
+//! event queues, as reported through registerLookahead(), or MaxTick
+//! if there are no such links. Adaptive synchronization uses it as
+//! the quantum.
+extern Tick simLookahead;
+
+//! Whether the main event queues synchronize adaptively, i.e. skip
+//! ahead to the earliest pending event rather than meeting every
+//! quantum (see GlobalSyncEvent).
+extern bool simQuantumAdaptive;
+
 //! Current number of allocated main event queues.
 extern uint32_t numMainEventQueues;
 
@@ -137,6 +152,11 @@ class EventBase
     /// sure we don't tick both CPUs in the same cycle.
     static const Priority CPU_Switch_Pri =             -31;
 
+    /// Messages passed between event queues are delivered ahead of
+    /// anything else happening at their arrival tick, so that the
+    /// receiver sees them regardless of insertion order.
+    static const Priority Async_Delivery_Pri =          -2;
+
     /// For some reason "delayed" inter-cluster writebacks are
     /// scheduled before regular writebacks (which have default
     /// priority).  Steve?
@@ -183,6 +203,7 @@ class EventBase
 class Event : public EventBase, public Serializable
 {
     friend class EventQueue;
+    friend class EventCalendar;
 
   private:
     // The event queue is now a linked list of linked lists.  The
@@ -440,6 +461,12 @@ operator!=(const Event &l, const Event &r)
  * events must happen at least one simulation quantum into the future,
  * otherwise they risk being scheduled in the past by
  * handleAsyncInsertions().
+ *
+ * Pending events are normally kept on a single list of bins sorted by
+ * time and priority. Queues holding many pending events at distinct
+ * times can switch to a calendar queue instead (see useCalendar()),
+ * which makes insertion and removal roughly constant time. Both keep
+ * the same order and checkpoint format.
  */
 class EventQueue : public Serializable
 {
@@ -448,11 +475,27 @@ class EventQueue : public Serializable
     Event *head;
     Tick _curTick;
 
-    //! Mutex to protect async queue.
-    std::mutex async_queue_mutex;
+    //! Calendar ordering the bins, NULL when using the sorted list.
+    //! 'head' mirrors its front either way.
+    EventCalendar *calendar;
 
-    //! List of events added by other threads to this event queue.
-    std::list<Event*> async_queue;
+    //! Host time profile of the events serviced, NULL unless enabled.
+    EventProfile *profile;
+
+    /**
+     * Events added by other threads to this event queue, newest
+     * first. This is a lock-free stack linked through Event::nextBin,
+     * which is unused until the owning thread moves the events to the
+     * main queue. Any number of threads may push onto it, but only the
+     * owning thread takes events off, and it always takes all of them,
+     * so the stack isn't subject to ABA problems.
+     */
+    std::atomic<Event *> async_queue;
+
+    //! Statistics on asynchronous insertions and quantum barriers,
+    //! NULL unless regStats() has been called.
+    struct SyncStats;
+    SyncStats *syncStats;
 
     /**
      * Lock protecting event handling.
@@ -481,6 +524,9 @@ class EventQueue : public Serializable
     void insert(Event *event);
     void remove(Event *event);
 
+    //! Append the top event of every bin to bins, in service order.
+    void getBins(std::vector<Event *> &bins) const;
+
     //! Function for adding events to the async queue. The added events
     //! are added to main event queue later. Threads, other than the
     //! owning thread, should call this function instead of insert().
@@ -569,6 +615,14 @@ class EventQueue : public Serializable
     void reschedule(Event *event, Tick when, bool always = false);
 
     Tick nextTick() const { return head->when(); }
+
+    /**
+     * Earliest tick of any pending event, including events still
+     * waiting on the async queue. MaxTick if there are none. Only
+     * meaningful while no other thread can schedule on this queue,
+     * e.g. while all threads wait at a global barrier.
+     */
+    Tick nextPendingTick() const;
     void setCurTick(Tick newVal) { _curTick = newVal; }
     Tick getCurTick() { return _curTick; }
 
@@ -605,6 +659,34 @@ class EventQueue : public Serializable
     //! Function for moving events from the async_queue to the main queue.
     void handleAsyncInsertions();
 
+    //! Account for host time the owning thread spent waiting for the
+    //! other threads at a quantum barrier.
+    void barrierWaited(double seconds);
+
+    /**
+     * Register statistics on the events other threads schedule on this
+     * queue, both in total and per call to handleAsyncInsertions(),
+     * i.e., per simulation quantum, and on the time the owning thread
+     * waits at quantum barriers.
+     */
+    void regStats(const std::string &name);
+
+    /**
+     * Switch between the sorted list and the calendar queue for
+     * ordering pending events. Events already scheduled are carried
+     * over. Should only be called by the owning thread.
+     */
+    void useCalendar(bool enable);
+    bool usingCalendar() const { return calendar != NULL; }
+
+    /**
+     * Start keeping a profile of the host time spent processing each
+     * kind of event (see EventProfile). Should only be called by the
+     * owning thread.
+     */
+    void enableProfile(unsigned sample_period, bool by_name);
+    EventProfile *getProfile() const { return profile; }
+
     /**
      *  Function to signal that the event loop should be woken up because
      *  an event has been scheduled by an agent outside the gem5 event
@@ -651,9 +733,17 @@ class EventQueue : public Serializable
     virtual void unserialize(Checkpoint *cp, const std::string &section);
 #endif
 
-    virtual ~EventQueue() { }
+    virtual ~EventQueue();
 };
 
+/**
+ * Report that anything an object on queue 'from' passes to an object
+ * on queue 'to' arrives at least 'latency' ticks later. Called by
+ * objects linking event queues, typically from init(); links within a
+ * single queue are ignored.
+ */
+void registerLookahead(EventQueue *from, EventQueue *to, Tick latency);
+
 void dumpMainQueue();
 
 #ifndef SWIG
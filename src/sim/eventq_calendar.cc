@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "sim/eventq.hh"
+#include "sim/eventq_calendar.hh"
+
+using namespace std;
+
+namespace {
+
+bool
+earlierBin(const Event *l, const Event *r)
+{
+    return *l < *r;
+}
+
+} // anonymous namespace
+
+EventCalendar::EventCalendar()
+    : buckets(MinBuckets, NULL), widthBits(10), numBins(0), _front(NULL)
+{
+}
+
+Event *
+EventCalendar::findFront(Tick from) const
+{
+    if (!numBins)
+        return NULL;
+
+    // Walk the buckets one width at a time starting at the bucket of
+    // 'from'. The first bin falling inside the window of the bucket it
+    // is in is the earliest one. Windows past MaxTick wrap around and
+    // can never match, which ends up in the direct search below.
+    const Tick width = Tick(1) << widthBits;
+    size_t b = bucket(from);
+    Tick window_end = ((from >> widthBits) + 1) << widthBits;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Event *bin = buckets[b];
+        if (bin && bin->when() < window_end)
+            return bin;
+        b = (b + 1) & (buckets.size() - 1);
+        window_end += width;
+    }
+
+    // Every bin is at least a full calendar away, so fall back to
+    // comparing the head of every bucket.
+    Event *earliest = NULL;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i] && (!earliest || *buckets[i] < *earliest))
+            earliest = buckets[i];
+    }
+    return earliest;
+}
+
+void
+EventCalendar::insert(Event *event)
+{
+    Event **link = &buckets[bucket(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    Event *curr = *link;
+    bool new_bin = !curr || *event < *curr;
+    *link = Event::insertBefore(event, curr);
+
+    // An event equal to the front goes on top of the front's bin.
+    if (!_front || *event <= *_front)
+        _front = event;
+
+    if (new_bin && ++numBins > 2 * buckets.size())
+        resize(2 * buckets.size());
+}
+
+void
+EventCalendar::remove(Event *event)
+{
+    Event **link = &buckets[bucket(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    Event *bin = *link;
+    if (!bin || *bin != *event)
+        panic("event not found!");
+
+    bool emptied = bin == event && !event->nextInBin;
+    *link = Event::removeItem(event, bin);
+
+    if (emptied) {
+        numBins--;
+        if (_front == bin)
+            _front = findFront(event->when());
+        if (buckets.size() > MinBuckets && numBins < buckets.size() / 2)
+            resize(buckets.size() / 2);
+    } else if (_front == bin) {
+        _front = *link;
+    }
+}
+
+void
+EventCalendar::popFront()
+{
+    Event *event = _front;
+    assert(event);
+
+    // The earliest bin is always the first one in its bucket.
+    Event **link = &buckets[bucket(event->when())];
+    assert(*link == event);
+
+    Event *next = event->nextInBin;
+    if (next) {
+        // nextBin is only valid on the top event of a bin
+        next->nextBin = event->nextBin;
+        *link = next;
+        _front = next;
+    } else {
+        *link = event->nextBin;
+        numBins--;
+        _front = findFront(event->when());
+        if (buckets.size() > MinBuckets && numBins < buckets.size() / 2)
+            resize(buckets.size() / 2);
+    }
+}
+
+Event *
+EventCalendar::extract()
+{
+    vector<Event *> bins;
+    getBins(bins);
+
+    for (size_t i = 0; i < bins.size(); ++i)
+        bins[i]->nextBin = i + 1 < bins.size() ? bins[i + 1] : NULL;
+
+    buckets.assign(buckets.size(), NULL);
+    numBins = 0;
+    _front = NULL;
+
+    return bins.empty() ? NULL : bins[0];
+}
+
+void
+EventCalendar::insertBins(Event *list)
+{
+    assert(!numBins);
+
+    vector<Event *> bins;
+    for (Event *bin = list; bin; bin = bin->nextBin)
+        bins.push_back(bin);
+
+    size_t num_buckets = MinBuckets;
+    while (2 * num_buckets < bins.size())
+        num_buckets *= 2;
+    rebuild(bins, num_buckets);
+}
+
+void
+EventCalendar::getBins(vector<Event *> &bins) const
+{
+    size_t first = bins.size();
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        for (Event *bin = buckets[i]; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+    sort(bins.begin() + first, bins.end(), earlierBin);
+}
+
+void
+EventCalendar::rebuild(vector<Event *> &bins, size_t num_buckets)
+{
+    // Pick a width that puts around three of the earliest bins, which
+    // are the next to be serviced, into each bucket.
+    size_t sample = min<size_t>(bins.size(), 32);
+    if (sample > 1) {
+        Tick gap = (bins[sample - 1]->when() - bins[0]->when()) /
+            (sample - 1);
+        gap = min<Tick>(gap, Tick(1) << 40);
+        widthBits = gap ? ceilLog2(3 * gap) : 0;
+    }
+
+    buckets.assign(num_buckets, NULL);
+    numBins = bins.size();
+
+    // Push the bins from the back so that every bucket ends up sorted.
+    for (size_t i = bins.size(); i-- > 0; ) {
+        Event **head = &buckets[bucket(bins[i]->when())];
+        bins[i]->nextBin = *head;
+        *head = bins[i];
+    }
+
+    _front = bins.empty() ? NULL : bins[0];
+}
+
+void
+EventCalendar::resize(size_t num_buckets)
+{
+    vector<Event *> bins;
+    getBins(bins);
+    rebuild(bins, num_buckets);
+}
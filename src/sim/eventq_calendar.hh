@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __SIM_EVENTQ_CALENDAR_HH__
+#define __SIM_EVENTQ_CALENDAR_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+
+class Event;
+
+/**
+ * Calendar queue (R. Brown, CACM 1988) ordering the bins of an
+ * EventQueue.
+ *
+ * A bin is the same LIFO stack of equal (when, priority) events that
+ * the list-based EventQueue uses, headed by its most recently inserted
+ * event. Rather than keeping every bin on one sorted list, bins are
+ * hashed by time into buckets of a fixed width; each bucket is a list
+ * of bins sorted by (when, priority) and linked through
+ * Event::nextBin. Inserting and removing then only walk the few bins
+ * sharing a bucket, and the earliest bin is found by scanning forward
+ * from the bucket of the last one. The bucket count follows the number
+ * of bins, and the width is re-estimated from the spacing of the
+ * earliest bins whenever the buckets are resized.
+ *
+ * Ordering is identical to the list: bins are serviced in (when,
+ * priority) order and the events of a bin in LIFO order.
+ */
+class EventCalendar
+{
+  private:
+    /** Smallest number of buckets the calendar shrinks to. */
+    static const size_t MinBuckets = 16;
+
+    /** Per bucket: the earliest bin or NULL. */
+    std::vector<Event *> buckets;
+    /** log2 of the bucket width in ticks. */
+    unsigned widthBits;
+    /** Number of bins in the calendar. */
+    size_t numBins;
+    /** The earliest bin. */
+    Event *_front;
+
+    size_t
+    bucket(Tick when) const
+    {
+        return (when >> widthBits) & (buckets.size() - 1);
+    }
+
+    /** Find the earliest bin, given that no bin is earlier than from. */
+    Event *findFront(Tick from) const;
+
+    /** Rehash the bins, which must be in order, into num_buckets. */
+    void rebuild(std::vector<Event *> &bins, size_t num_buckets);
+    void resize(size_t num_buckets);
+
+  public:
+    EventCalendar();
+
+    /** The top event of the earliest bin, NULL if empty. */
+    Event *front() const { return _front; }
+
+    void insert(Event *event);
+    void remove(Event *event);
+
+    /** Remove the top event of the earliest bin. */
+    void popFront();
+
+    /**
+     * Take all bins out of the calendar.
+     *
+     * @return The bins linked into a sorted list through nextBin,
+     * i.e., in the layout of the list-based EventQueue.
+     */
+    Event *extract();
+
+    /** Move the bins of a sorted list into an empty calendar. */
+    void insertBins(Event *bins);
+
+    /** Append the top event of every bin to bins, in order. */
+    void getBins(std::vector<Event *> &bins) const;
+};
+
+#endif // __SIM_EVENTQ_CALENDAR_HH__
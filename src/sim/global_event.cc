@@ -31,6 +31,10 @@
 
 #include "sim/global_event.hh"
 
+#include <algorithm>
+
+#include "base/time.hh"
+
 std::mutex BaseGlobalEvent::globalQMutex;
 
 BaseGlobalEvent::BaseGlobalEvent(Priority p, Flags f)
@@ -140,6 +144,9 @@ GlobalEvent::BarrierEvent::process()
 void
 GlobalSyncEvent::BarrierEvent::process()
 {
+    Time start;
+    start.setTimer();
+
     // wait for all queues to arrive at barrier, then process event
     if (globalBarrier()) {
         _globalEvent->process();
@@ -148,15 +155,37 @@ GlobalSyncEvent::BarrierEvent::process()
     // second barrier to force all queues to wait for event processing
     // to finish before continuing
     globalBarrier();
+
+    Time end;
+    end.setTimer();
+    curEventQueue()->barrierWaited(end - start);
+
     curEventQueue()->handleAsyncInsertions();
 }
 
 void
 GlobalSyncEvent::process()
 {
-    if (repeat) {
-        schedule(curTick() + repeat);
+    if (!repeat)
+        return;
+
+    Tick from = curTick();
+    if (adaptive) {
+        // All other threads are waiting at the barrier, so their
+        // queues can be inspected. Nothing can cross between queues
+        // earlier than one quantum after the earliest pending event,
+        // so idle stretches before that event needn't be synchronized.
+        Tick earliest = MaxTick;
+        for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+            earliest = std::min(earliest,
+                                mainEventQueue[i]->nextPendingTick());
+        }
+        from = std::max(from, earliest);
+        if (from > MaxTick - repeat)
+            return;
     }
+
+    schedule(from + repeat);
 }
 
 const char *
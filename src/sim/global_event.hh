@@ -203,6 +203,11 @@ class GlobalEvent : public BaseGlobalEventTemplate<GlobalEvent>
  * A special global event that synchronizes all threads and forces
  * them to process asynchronously enqueued events.  Useful for
  * separating quanta in a quantum-based parallel simulation.
+ *
+ * A repeating event normally recurs every 'repeat' ticks. An adaptive
+ * one instead recurs 'repeat' ticks after the earliest event pending
+ * on any queue, which is as safe provided no event crosses between
+ * queues sooner than 'repeat' ticks after it is caused.
  */
 class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
 {
@@ -222,8 +227,9 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
         : Base(p, f)
     { }
 
-    GlobalSyncEvent(Tick when, Tick _repeat, Priority p, Flags f)
-        : Base(p, f), repeat(_repeat)
+    GlobalSyncEvent(Tick when, Tick _repeat, Priority p, Flags f,
+                    bool _adaptive = false)
+        : Base(p, f), repeat(_repeat), adaptive(_adaptive)
     {
         schedule(when);
     }
@@ -233,6 +239,7 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
     const char *description() const;
 
     Tick repeat;
+    bool adaptive;
 };
 
 
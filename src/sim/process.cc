@@ -48,7 +48,9 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 
+#include "arch/tlb.hh"
 #include "base/loader/object_file.hh"
 #include "base/loader/symtab.hh"
 #include "base/intmath.hh"
@@ -340,8 +342,70 @@ void
 Process::allocateMem(Addr vaddr, int64_t size, bool clobber)
 {
     int npages = divCeil(size, (int64_t)PageBytes);
-    Addr paddr = system->allocPhysPages(npages);
-    pTable->map(vaddr, paddr, size, clobber ? PageTableBase::Clobber : 0);
+    int flags = clobber ? PageTableBase::Clobber : 0;
+
+    // Pages freed by backWithHugePages() are reused one at a time.
+    Addr paddr;
+    while (npages && system->allocFreedPhysPage(paddr)) {
+        pTable->map(vaddr, paddr, PageBytes, flags);
+        vaddr += PageBytes;
+        npages--;
+    }
+    if (!npages)
+        return;
+
+    paddr = system->allocPhysPages(npages);
+    pTable->map(vaddr, paddr, npages * PageBytes, flags);
+}
+
+bool
+Process::backWithHugePages(Addr vaddr, int64_t size, Addr huge_page_size)
+{
+    fatal_if(!isPowerOf2(huge_page_size) || huge_page_size < PageBytes,
+             "Invalid huge page size %d.", huge_page_size);
+
+    Addr start = roundDown(vaddr, PageBytes);
+    Addr end = roundUp(vaddr + size, PageBytes);
+    int npages = (end - start) / PageBytes;
+
+    // Nothing to do if the region is already laid out this way, e.g.
+    // because the same array was mapped before.
+    Addr first_paddr;
+    bool contiguous = pTable->translate(start, first_paddr) &&
+        ((first_paddr - start) & (huge_page_size - 1)) == 0;
+    for (Addr offset = PageBytes; contiguous && offset < end - start;
+         offset += PageBytes) {
+        Addr paddr;
+        contiguous = pTable->translate(start + offset, paddr) &&
+            paddr == first_paddr + offset;
+    }
+    if (contiguous)
+        return false;
+
+    // Place the copy at the same offset within a huge page as the virtual
+    // region, and give the old pages back.
+    Addr paddr = system->allocAlignedPhysPages(
+        npages, huge_page_size, start & (huge_page_size - 1));
+
+    std::vector<uint8_t> page(PageBytes);
+    for (Addr offset = 0; offset < end - start; offset += PageBytes) {
+        Addr old_paddr;
+        if (pTable->translate(start + offset, old_paddr)) {
+            system->physProxy.readBlob(old_paddr, page.data(), PageBytes);
+            system->physProxy.writeBlob(paddr + offset, page.data(),
+                                        PageBytes);
+            system->freePhysPages(old_paddr, 1);
+        }
+    }
+    pTable->map(start, paddr, end - start, PageTableBase::Clobber);
+
+    // The CPUs may still hold translations to the old pages.
+    for (int i = 0; i < system->numContexts(); i++) {
+        ThreadContext *tc = system->getThreadContext(i);
+        tc->getITBPtr()->flushAll();
+        tc->getDTBPtr()->flushAll();
+    }
+    return true;
 }
 
 bool
@@ -215,6 +215,16 @@ class Process : public SimObject
 
     void allocateMem(Addr vaddr, int64_t size, bool clobber = false);
 
+    /**
+     * Move the pages of a region onto physically contiguous memory whose
+     * offset within a huge page matches that of the virtual addresses,
+     * so that every naturally aligned huge page inside the region can be
+     * translated by a single entry. The current contents are preserved,
+     * and the TLBs of the CPUs are flushed.
+     * @return Whether any page was moved.
+     */
+    bool backWithHugePages(Addr vaddr, int64_t size, Addr huge_page_size);
+
     /// Attempt to fix up a fault at vaddr by allocating a page on the stack.
     /// @return Whether the fault has been fixed.
     bool fixupStackFault(Addr vaddr);
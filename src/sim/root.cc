@@ -35,6 +35,7 @@
 #include "base/trace.hh"
 #include "config/the_isa.hh"
 #include "debug/TimeSync.hh"
+#include "sim/event_profile.hh"
 #include "sim/full_system.hh"
 #include "sim/root.hh"
 
@@ -114,6 +115,32 @@ Root::Root(RootParams *p) : SimObject(p), _enabled(false),
     lastTime.setTimer();
 
     simQuantum = p->sim_quantum;
+    simQuantumAdaptive = p->sim_quantum_adaptive;
+}
+
+void
+Root::init()
+{
+    SimObject::init();
+
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        mainEventQueue[i]->useCalendar(params()->calendar_event_queue);
+
+    if (params()->event_profile) {
+        enableEventProfile(params()->event_profile_sample,
+                           params()->event_profile_by_name);
+    }
+}
+
+void
+Root::regStats()
+{
+    SimObject::regStats();
+
+    if (numMainEventQueues > 1) {
+        for (uint32_t i = 0; i < numMainEventQueues; ++i)
+            mainEventQueue[i]->regStats(csprintf("%s.eventq%d", name(), i));
+    }
 }
 
 void
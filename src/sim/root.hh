@@ -108,10 +108,19 @@ class Root : public SimObject
      */
     void loadState(Checkpoint *cp);
 
+    /** Select the ordering used by the main event queues
+     */
+    void init();
+
     /** Schedule the timesync event at initState() when not unserializing
      */
     void initState();
 
+    /** Register the cross-queue scheduling stats of every main event
+     * queue when simulating with more than one.
+     */
+    void regStats();
+
     virtual void serialize(std::ostream &os);
     virtual void unserialize(Checkpoint *cp, const std::string &section);
 
@@ -114,12 +114,26 @@ simulate(Tick num_cycles)
 
     GlobalSyncEvent *quantum_event = NULL;
     if (numMainEventQueues > 1) {
+        if (simQuantumAdaptive && simLookahead != MaxTick) {
+            // The lookahead is the longest quantum that keeps the
+            // simulation exact; a shorter explicit quantum still wins.
+            if (simLookahead == 0)
+                fatal("Zero latency link between event queues, can't "
+                      "synchronize adaptively");
+            if (simQuantum == 0 || simQuantum > simLookahead) {
+                inform("Synchronizing event queues adaptively, using the "
+                       "%d tick lookahead as quantum\n", simLookahead);
+                simQuantum = simLookahead;
+            }
+        }
+
         if (simQuantum == 0) {
             fatal("Quantum for multi-eventq simulation not specified");
         }
 
         quantum_event = new GlobalSyncEvent(curTick() + simQuantum, simQuantum,
-                            EventBase::Progress_Event_Pri, 0);
+                            EventBase::Progress_Event_Pri, 0,
+                            simQuantumAdaptive);
 
         inParallelMode = true;
     }
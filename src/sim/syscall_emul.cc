@@ -33,11 +33,14 @@
 #include <unistd.h>
 
 #include <cstdio>
+#include <algorithm>
 #include <iostream>
 #include <string>
 
+#include "aladdin/gem5/Gem5Datapath.h"
 #include "arch/utility.hh"
 #include "base/chunk_generator.hh"
+#include "base/intmath.hh"
 #include "base/loader/object_file.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
@@ -597,114 +600,177 @@ dupFunc(SyscallDesc *desc, int num, LiveProcess *process, ThreadContext *tc)
         process->alloc_fd(result, fdo->filename, fdo->flags, fdo->mode, false);
 }
 
+/// Size in bytes of a pointer or size_t in the simulated process.
+static size_t
+aladdinWordSize(LiveProcess *process)
+{
+    return process->getObjectFileArch() == ObjectFile::X86_64 ? 8 : 4;
+}
+
+/// An aladdin_map_t as laid out in the simulated process. Every field
+/// occupies one target word.
+struct AladdinMapping
+{
+    static const int NumWords = 4;
+
+    Addr nameAddr;
+    Addr vaddr;
+    unsigned requestCode;
+    Addr size;
+
+    AladdinMapping(const uint64_t *words)
+        : nameAddr(words[0]), vaddr(words[1]), requestCode(words[2]),
+          size(words[3])
+    { }
+};
+
+/// Read the aladdin_map_t at mapping_ptr in the simulated process.
+static AladdinMapping
+readAladdinMapping(LiveProcess *process, ThreadContext *tc, Addr mapping_ptr)
+{
+    uint64_t words[AladdinMapping::NumWords];
+    tc->getMemProxy().readWords(mapping_ptr, words, AladdinMapping::NumWords,
+                                aladdinWordSize(process));
+    return AladdinMapping(words);
+}
+
+/// Map one array into an accelerator: record its label and insert the
+/// translations of every page it touches, taking into account straddling
+/// page boundaries. Pages that are contiguous both virtually and
+/// physically are handed over as a single range. Returns the number of
+/// pages mapped.
+static unsigned
+mapAladdinArray(LiveProcess *process, AcceleratorManager *accel_manager,
+                AcceleratorManager::AccelHandle handle,
+                const std::string &array_name, Addr sim_base_addr, Addr size)
+{
+    // Move the array onto huge pages first so that the ranges below are
+    // physically contiguous. Arrays mapped earlier may share its first or
+    // last page, and their translations moved with it.
+    if (accel_manager->hugePageSize() && size &&
+        process->backWithHugePages(sim_base_addr, size,
+                                   accel_manager->hugePageSize()))
+        accel_manager->refreshTranslations(process->pTable, sim_base_addr,
+                                           size, TheISA::PageBytes);
+
+    accel_manager->datapath(handle)->insertArrayLabelToVirtual(
+        array_name, sim_base_addr);
+
+    Addr starting_page_offset = sim_base_addr & (TheISA::PageBytes - 1);
+    unsigned num_pages =
+        divCeil(size + starting_page_offset, TheISA::PageBytes);
+    Addr range_vaddr = sim_base_addr;
+    Addr range_paddr = 0;
+    Addr range_size = 0;
+    for (unsigned i = 0; i < num_pages; i++) {
+        Addr vaddr = sim_base_addr + i*TheISA::PageBytes;
+        Addr paddr;
+        process->pTable->translate(vaddr, paddr);
+        if (range_size && paddr != range_paddr + range_size) {
+            accel_manager->insertTranslation(handle, range_vaddr,
+                                             range_paddr, range_size,
+                                             TheISA::PageBytes);
+            range_size = 0;
+        }
+        if (!range_size) {
+            range_vaddr = vaddr;
+            range_paddr = paddr;
+        }
+        range_size += TheISA::PageBytes;
+    }
+    if (range_size)
+        accel_manager->insertTranslation(handle, range_vaddr, range_paddr,
+                                         range_size, TheISA::PageBytes);
+    return num_pages;
+}
+
 void
 fcntlAladdinHandler(LiveProcess *process, ThreadContext *tc)
 {
     int index = 2;
     Addr mapping_ptr = (Addr) process->getSyscallArg(tc, index);
-    SETranslatingPortProxy& memProxy = tc->getMemProxy();
+    AladdinMapping mapping = readAladdinMapping(process, tc, mapping_ptr);
 
-    // Deserialize the mapping struct bytes.
-    size_t word_size = 4;
-    if (process->getObjectFileArch() == ObjectFile::X86_64) {
-      word_size = 8;
-    }
-    uint8_t* mapping_buf = new uint8_t[sizeof(aladdin_map_t)];
-    memProxy.readBlob(mapping_ptr, mapping_buf, sizeof(aladdin_map_t));
-    aladdin_map_t mapping;
-    // Initialize all values to 0 so we avoid garbage from 32-bit to 64-bit
-    // conversions and only keep what we copy.
-    mapping.addr = nullptr;
-    void* array_name_addr = nullptr;
-    mapping.request_code = 0;
-    mapping.size = 0;
-    memcpy(&array_name_addr, &(mapping_buf[0]), word_size);
-    memcpy(&(mapping.addr), &(mapping_buf[word_size]), word_size);
-    memcpy(&(mapping.request_code), &(mapping_buf[2*word_size]), word_size);
-    memcpy(&(mapping.size), &(mapping_buf[3*word_size]), word_size);
-
-    // Extract the array name. Assume the variable name is at most 100 chars.
-    Addr string_addr = (Addr) array_name_addr;
-    uint8_t* string_buf = new uint8_t[20];
-    memProxy.readBlob(string_addr, string_buf, 20);
-    mapping.array_name = (const char*) string_buf;
+    std::string array_name;
+    tc->getMemProxy().readString(array_name, mapping.nameAddr);
 
     inform("Received mapping for array %s at vaddr %x of length %d.\n",
-           mapping.array_name, mapping.addr, mapping.size);
-    Addr sim_base_addr = reinterpret_cast<Addr>(mapping.addr);
+           array_name, mapping.vaddr, mapping.size);
 
     // TODO: Do we need to delete past mappings of the same array? Would it
     // cause issues if we don't?
-    process->system->insertArrayLabelMapping(
-          mapping.request_code,
-          mapping.array_name, sim_base_addr);
+    // Resolve the datapath instance serving this thread once; every
+    // mapping below goes to the same instance.
+    AcceleratorManager *accel_manager = process->system->accelManager;
+    AcceleratorManager::AccelHandle handle =
+        accel_manager->lookup(mapping.requestCode, tc->contextId());
+    mapAladdinArray(process, accel_manager, handle, array_name,
+                    mapping.vaddr, mapping.size);
+}
 
-    // Set up all mappings, taking into account straddling page boundaries.
-    Addr starting_page_offset = sim_base_addr & (TheISA::PageBytes - 1);
-    int num_pages = ceil(
-        ((float)mapping.size + starting_page_offset) / TheISA::PageBytes);
-    for (int i = 0; i < num_pages; i++) {
-      Addr paddr;
-      process->pTable->translate(
-          sim_base_addr + i*TheISA::PageBytes, paddr);
-      process->system->insertAddressTranslationMapping(
-          mapping.request_code,
-          sim_base_addr + i*TheISA::PageBytes,  // Simulated vaddr.
-          paddr);  // Simulated paddr.
+int
+fcntlAladdinBatchHandler(LiveProcess *process, ThreadContext *tc)
+{
+    int index = 2;
+    Addr mappings_ptr = (Addr) process->getSyscallArg(tc, index);
+    unsigned num_mappings = process->getSyscallArg(tc, index);
+    SETranslatingPortProxy& memProxy = tc->getMemProxy();
+
+    // Pull the descriptors in a block at a time through a fixed buffer so
+    // that large batches don't need any heap storage.
+    const unsigned block_mappings = 32;
+    uint64_t words[block_mappings * AladdinMapping::NumWords];
+    size_t word_size = aladdinWordSize(process);
+    size_t desc_size = AladdinMapping::NumWords * word_size;
+
+    AcceleratorManager *accel_manager = process->system->accelManager;
+    AcceleratorManager::AccelHandle handle =
+        AcceleratorManager::InvalidAccelHandle;
+    unsigned last_request_code = 0;
+    unsigned num_pages = 0;
+    for (unsigned i = 0; i < num_mappings; i++) {
+        unsigned slot = i % block_mappings;
+        if (slot == 0) {
+            unsigned count = std::min(block_mappings, num_mappings - i);
+            memProxy.readWords(mappings_ptr + i * desc_size, words,
+                               count * AladdinMapping::NumWords, word_size);
+        }
+        AladdinMapping mapping(&words[slot * AladdinMapping::NumWords]);
+
+        // Batches normally target a single accelerator, so only go back
+        // to the registry when the request code changes.
+        if (handle == AcceleratorManager::InvalidAccelHandle ||
+            mapping.requestCode != last_request_code) {
+            handle = accel_manager->lookup(mapping.requestCode,
+                                           tc->contextId());
+            last_request_code = mapping.requestCode;
+        }
+
+        std::string array_name;
+        memProxy.readString(array_name, mapping.nameAddr);
+        num_pages += mapAladdinArray(process, accel_manager, handle,
+                                     array_name, mapping.vaddr,
+                                     mapping.size);
     }
 
-    delete mapping_buf;
-    delete string_buf;
+    inform("Mapped %d arrays (%d pages) for accelerator use.\n",
+           num_mappings, num_pages);
+    return num_pages;
 }
 
-bool forwardAccTaskData = false;
-BaseCPU *cpuPtr;
-
 void fcntlRegAccTaskDataForCache(LiveProcess *process, ThreadContext *tc) {
     int index = 2;
     Addr mapping_ptr = (Addr) process->getSyscallArg(tc, index);
-    SETranslatingPortProxy& memProxy = tc->getMemProxy();
+    AladdinMapping mapping = readAladdinMapping(process, tc, mapping_ptr);
 
-    // Deserialize the mapping struct bytes.
-    size_t word_size = 4;
-    if (process->getObjectFileArch() == ObjectFile::X86_64) {
-      word_size = 8;
-    }
-    uint8_t* mapping_buf = new uint8_t[sizeof(aladdin_map_t)];
-    memProxy.readBlob(mapping_ptr, mapping_buf, sizeof(aladdin_map_t));
-    aladdin_map_t mapping;
-    // Initialize all values to 0 so we avoid garbage from 32-bit to 64-bit
-    // conversions and only keep what we copy.
-    mapping.addr = nullptr;
-    void* array_name_addr = nullptr;
-    mapping.request_code = 0;
-    mapping.size = 0;
-    memcpy(&array_name_addr, &(mapping_buf[0]), word_size);
-    memcpy(&(mapping.addr), &(mapping_buf[word_size]), word_size);
-    memcpy(&(mapping.request_code), &(mapping_buf[2*word_size]), word_size);
-    memcpy(&(mapping.size), &(mapping_buf[3*word_size]), word_size);
-
-    // Extract the array name. Assume the variable name is at most 100 chars.
-    Addr string_addr = (Addr) array_name_addr;
-    uint8_t* string_buf = new uint8_t[100];
-    memProxy.readBlob(string_addr, string_buf, 100);
-    mapping.array_name = (const char*) string_buf;
-
-    Addr sim_base_addr = reinterpret_cast<Addr>(mapping.addr);
-
-    tc->getCpuPtr()->setAccTaskDataRange(sim_base_addr, mapping.size);
-    forwardAccTaskData = true;
-    cpuPtr = tc->getCpuPtr();
-
-    auto range = tc->getCpuPtr()->getAccTaskDataRange();
-    inform("Received L1 cache registration for ACC-task Data at %x - %x, size: %u.\n",
-           range.first, range.second, mapping.size);
+    process->system->accTaskData(tc->contextId()).addRange(
+        mapping.vaddr, mapping.size);
 
-    delete mapping_buf;
-    delete string_buf;
+    inform("Received L1 cache registration for ACC-task Data at %x - %x, size: %u.\n",
+           mapping.vaddr, mapping.vaddr + mapping.size, mapping.size);
 }
 void fcntlDelAccTaskDataForCache(LiveProcess *process, ThreadContext *tc) {
-    forwardAccTaskData = false;
+    process->system->accTaskData(tc->contextId()).clear();
 }
 
 SyscallReturn
@@ -721,6 +787,8 @@ fcntlFunc(SyscallDesc *desc, int num, LiveProcess *process,
     if (cmd == ALADDIN_MAP_ARRAY) {
         fcntlAladdinHandler(process, tc);
         return 0;
+    } else if (cmd == ALADDIN_MAP_ARRAYS) {
+        return fcntlAladdinBatchHandler(process, tc);
     } else if(cmd == REG_ACC_TASK_DATA) {
         fcntlRegAccTaskDataForCache(process, tc);
         return 0;
@@ -775,6 +843,8 @@ fcntl64Func(SyscallDesc *desc, int num, LiveProcess *process,
     if (cmd == ALADDIN_MAP_ARRAY) {
         fcntlAladdinHandler(process, tc);
         return 0;
+    } else if (cmd == ALADDIN_MAP_ARRAYS) {
+        return fcntlAladdinBatchHandler(process, tc);
     } else if(cmd == REG_ACC_TASK_DATA) {
         fcntlRegAccTaskDataForCache(process, tc);
         return 0;
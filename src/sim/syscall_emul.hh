@@ -88,6 +88,13 @@
 #include "aladdin/gem5/aladdin_sys_connection.h"
 #include "aladdin/gem5/aladdin_sys_constants.h"
 
+#ifndef ALADDIN_MAP_ARRAYS
+/// fcntl command mapping a batch of arrays with one call. The third
+/// argument points to an array of aladdin_map_t and the fourth holds the
+/// number of entries.
+#define ALADDIN_MAP_ARRAYS 0x10000003
+#endif
+
 ///
 /// System call descriptor.
 ///
@@ -263,6 +270,9 @@ SyscallReturn fcntl64Func(SyscallDesc *desc, int num,
 // Aladdin handler function shared between 32-bit and 64-bit fcntl emulations.
 void fcntlAladdinHandler(LiveProcess *process, ThreadContext *tc);
 
+// Batched variant of fcntlAladdinHandler. Returns the number of pages mapped.
+int fcntlAladdinBatchHandler(LiveProcess *process, ThreadContext *tc);
+
 // Our cache forwarding mechanism for ACC-Task Data shared between 32-bit and 64-bit fcntl emulations.
 void fcntlRegAccTaskDataForCache(LiveProcess *process, ThreadContext *tc);
 
@@ -578,23 +588,18 @@ ioctlFunc(SyscallDesc *desc, int callnum, LiveProcess *process,
 
     if (fd == ALADDIN_FD) {
       if (req == DUMP_STATS || req == RESET_STATS) {
-        size_t max_desc_len = 100;
+        // Descriptions longer than this are cut short.
+        const int max_desc_len = 100;
 
-        // Read the description string out of simulated memory.  We make the
-        // char buffer one character longer than the max length so that we can
-        // set the last character to the terminating character in case the
-        // string actually exceeds the max length allowed.
+        // Read the description string out of simulated memory. It may
+        // carry dump filter options, see m5.stats.parseDumpDesc().
         Addr desc_addr = (Addr) process->getSyscallArg(tc, index);
-        std::string stat_final_desc;
+        char desc_buf[max_desc_len + 1] = "";
         if (desc_addr != 0) {
-          SETranslatingPortProxy& memProxy = tc->getMemProxy();
-          uint8_t* desc_buf = new uint8_t[max_desc_len+2];
-          memProxy.readBlob(desc_addr, desc_buf, max_desc_len);
-          desc_buf[max_desc_len] = static_cast<uint8_t>(0);
-
-          char* stats_desc = (char*) desc_buf;
-          stat_final_desc = stats_desc;
+          tc->getMemProxy().readString(desc_buf, desc_addr,
+                                       sizeof(desc_buf));
         }
+        std::string stat_final_desc(desc_buf);
 
         // Create the final string to pass to exitSimLoop.
         std::string exit_sim_loop_reason = (req == DUMP_STATS) ?
@@ -45,8 +45,10 @@
  *          Rick Strong
  */
 
+#include "aladdin/gem5/Gem5Datapath.h"
 #include "arch/remote_gdb.hh"
 #include "arch/utility.hh"
+#include "base/intmath.hh"
 #include "base/loader/object_file.hh"
 #include "base/loader/symtab.hh"
 #include "base/str.hh"
@@ -80,6 +82,7 @@ int System::numSystemsRunning = 0;
 System::System(Params *p)
     : MemObject(p), _systemPort("system_port", this),
       _numContexts(0),
+      accelManager(p->accel_manager),
       pagePtr(0),
       init_param(p->init_param),
       physProxy(_systemPort, p->cache_line_size),
@@ -88,7 +91,8 @@ System::System(Params *p)
       loadAddrMask(p->load_addr_mask),
       loadAddrOffset(p->load_offset),
       nextPID(0),
-      physmem(name() + ".physmem", p->memories, p->mmap_using_noreserve),
+      physmem(name() + ".physmem", p->memories, p->mmap_using_noreserve,
+              p->incremental_checkpoints, p->uncompressed_checkpoints),
       memoryMode(p->mem_mode),
       //gooUnit(p->goounit),
       //datapath(p->datapath),
@@ -173,6 +177,9 @@ System::~System()
 
     for (uint32_t j = 0; j < numWorkIds; j++)
         delete workItemStats[j];
+
+    for (auto registry : accTaskDataRegs)
+        delete registry;
 }
 
 void
@@ -269,6 +276,39 @@ System::numRunningContexts()
     return running;
 }
 
+void
+System::insertAddressTranslationMapping(
+        int id, Addr sim_vaddr, Addr sim_paddr, int context_id)
+{
+    AccelHandle handle = accelManager->lookup(id, context_id);
+    accelManager->datapath(handle)->insertTLBEntry(sim_vaddr, sim_paddr);
+}
+
+void
+System::insertAddressRangeMapping(
+        int id, Addr sim_vaddr, Addr sim_paddr, Addr size, int context_id)
+{
+    accelManager->insertTranslation(accelManager->lookup(id, context_id),
+                                    sim_vaddr, sim_paddr, size, PageBytes);
+}
+
+void
+System::insertArrayLabelMapping(
+        int id, std::string array_label, Addr sim_vaddr, int context_id)
+{
+    AccelHandle handle = accelManager->lookup(id, context_id);
+    accelManager->datapath(handle)->insertArrayLabelToVirtual(
+        array_label, sim_vaddr);
+}
+
+Addr
+System::getArrayBaseAddress(int id, const char* array_name, int context_id)
+{
+    AccelHandle handle = accelManager->lookup(id, context_id);
+    return accelManager->datapath(handle)->getBaseAddress(
+        std::string(array_name));
+}
+
 void
 System::initState()
 {
@@ -339,6 +379,39 @@ System::allocPhysPages(int npages)
     return return_addr;
 }
 
+Addr
+System::allocAlignedPhysPages(int npages, Addr align, Addr offset)
+{
+    assert(isPowerOf2(align) && align >= PageBytes);
+    assert((offset & (PageBytes - 1)) == 0);
+
+    Addr next = pagePtr << PageShift;
+    int skipped = ((offset - next) & (align - 1)) >> PageShift;
+    Addr frames = allocPhysPages(skipped + npages);
+    fatal_if(frames != next, "Unable to allocate %d aligned pages.", npages);
+
+    freePhysPages(frames, skipped);
+    return frames + skipped * PageBytes;
+}
+
+void
+System::freePhysPages(Addr paddr, int npages)
+{
+    for (int i = 0; i < npages; i++)
+        freedPages.push_back(paddr + i * PageBytes);
+}
+
+bool
+System::allocFreedPhysPage(Addr &paddr)
+{
+    if (freedPages.empty())
+        return false;
+    paddr = freedPages.back();
+    freedPages.pop_back();
+    physProxy.memsetBlob(paddr, 0, PageBytes);
+    return true;
+}
+
 Addr
 System::memSize() const
 {
@@ -377,6 +450,7 @@ System::serialize(ostream &os)
     if (FullSystem)
         kernelSymtab->serialize("kernel_symtab", os);
     SERIALIZE_SCALAR(pagePtr);
+    arrayParamOut(os, "freedPages", freedPages);
     SERIALIZE_SCALAR(nextPID);
     serializeSymtab(os);
 
@@ -392,6 +466,10 @@ System::unserialize(Checkpoint *cp, const string &section)
     if (FullSystem)
         kernelSymtab->unserialize("kernel_symtab", cp, section);
     UNSERIALIZE_SCALAR(pagePtr);
+    // checkpoints taken before pages could be freed have no list
+    string freed_pages;
+    if (cp->find(section, "freedPages", freed_pages))
+        arrayParamIn(cp, section, "freedPages", freedPages);
     UNSERIALIZE_SCALAR(nextPID);
     unserializeSymtab(cp, section);
 
@@ -411,6 +489,21 @@ System::regStats()
                          .desc("Run time stat for" + namestr.str())
                          .prereq(*workItemStats[j]);
     }
+
+    // All thread contexts have registered by now.
+    accTaskDataRegs.resize(threadContexts.size());
+    for (int i = 0; i < accTaskDataRegs.size(); i++) {
+        accTaskDataRegs[i] = new AccTaskDataRegistry(_cacheLineSize);
+        accTaskDataRegs[i]->regStats(csprintf("%s.ctx%d", name(), i));
+    }
+}
+
+AccTaskDataRegistry &
+System::accTaskData(int context_id)
+{
+    panic_if(context_id < 0 || context_id >= accTaskDataRegs.size(),
+             "No task data registry for context %d.\n", context_id);
+    return *accTaskDataRegs[context_id];
 }
 
 void
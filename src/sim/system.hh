@@ -56,15 +56,15 @@
 #include "base/misc.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
+#include "cpu/acc_task_data.hh"
 #include "enums/MemoryMode.hh"
 #include "mem/mem_object.hh"
 #include "mem/port.hh"
 #include "mem/port_proxy.hh"
 #include "mem/physical.hh"
 #include "params/System.hh"
+#include "sim/accel_manager.hh"
 
-#include "aladdin/gem5/Gem5Datapath.h"
-#include "debug/Aladdin.hh"
 /**
  * To avoid linking errors with LTO, only include the header if we
  * actually have the definition.
@@ -75,6 +75,7 @@
 
 class BaseCPU;
 class BaseRemoteGDB;
+class Gem5Datapath;
 class GDBListener;
 class ObjectFile;
 class Platform;
@@ -210,135 +211,111 @@ class System : public MemObject
         return _numContexts;
     }
 
-    /* Stores a pointer to a datapath object with any dependencies (other
-     * accelerators that must finish execution before this accelerator an
-     * execute) the accelerator has.
-     * TODO: Deprecate the dependencies method and turn this into simple
-     * Gem5Datapath pointer.
+    /* Registry of the accelerator datapaths in this system. Datapaths are
+     * registered under an accelerator id, which can be an IOCTL request
+     * code. When gem5 intercepts the ioctl syscall, it will schedule the
+     * accelerator given by the request code for execution once the
+     * accelerators it depends on have completed.
      */
-    class AccelData {
-        public:
-          AccelData(Gem5Datapath *_datapath, std::vector<int> _deps)
-              : datapath(_datapath), deps(_deps) {}
+    AcceleratorManager *accelManager;
 
-            Gem5Datapath* datapath;
-            std::vector<int> deps;
-    };
-
-    /* Maps an accelerator id to an AccelData object. The id can be an IOCTL
-     * request code. When gem5 intercepts the ioctl syscall, it will schedule
-     * the accelerator given by the request code for execution.  This map
-     * specifies the set of accelerators that another accelerator depends on.
-     * Only when an accelerator's dependencies have completed can it proceed
-     * with execution. The size of the map is the number of executing
-     * accelerators.
-     */
-    std::map<int, AccelData*> accelerators;
+    typedef AcceleratorManager::AccelHandle AccelHandle;
 
     /* Returns the number of accelerators that are currently registered and
      * running in the system.
      */
     int numRunningAccelerators()
     {
-        return accelerators.size();
+        return accelManager->numInstances();
     }
 
     /* Registers the datapath pointer and list of dependencies with the system.
-     * If the accelerator already exists, the simulation ends with a fatal
-     * message.
-     */
-    void registerAccelerator(
-        int id, Gem5Datapath* accelerator, std::vector<int> accel_deps)
-    {
-        if (accelerators.find(id) != accelerators.end())
-            fatal("Unable to register accelerator: accelerator with id %#x "
-                  "already exists.", id);
-        accelerators[id] = new AccelData(accelerator, accel_deps);
-        DPRINTF(Aladdin, "Registered accelerator %d\n", id);
-    }
-
-    /* Marks an accelerator as finished by erasing it from the registered list. */
-    void deregisterAccelerator(int id)
+     * Registering several datapaths under the same id creates independent
+     * instances of that accelerator. Only accelerators registered with
+     * reports_completion, which call acceleratorFinished() at the end of
+     * every invocation, hold back the accelerators that depend on them.
+     */
+    AccelHandle registerAccelerator(
+        int id, Gem5Datapath* accelerator, std::vector<int> accel_deps,
+        bool reports_completion = false)
     {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to deregister accelerator: No accelerator with id %#x.", id);
-        delete accelerators[id];
-        accelerators.erase(id);
+        return accelManager->registerAccelerator(
+            id, accelerator, accel_deps, reports_completion);
     }
 
-    /* Register a pointer to use for communication between accelerator and CPU. */
-    void setAcceleratorFinishFlag(int id, Addr finish_flag)
-    {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to set finish flag: No accelerator with id %#x.", id);
-        accelerators[id]->datapath->setFinishFlag(finish_flag);
-    }
-
-    /* Sets context and thread ids for a given accelerator. These are needed
-     * for supporting cache prefetchers.
+    /* Called by a datapath when an invocation completes, as it writes the
+     * finish flag. Starts the invocations that were waiting on it.
      */
-    void setAcceleratorIds(int accel_id, int context_id, int thread_id)
+    void acceleratorFinished(AccelHandle handle)
     {
-        if (accelerators.find(accel_id) == accelerators.end())
-            fatal("Unable to set context thread ids: No accelerator with id %#x.",
-                  accel_id);
-        accelerators[accel_id]->datapath->setContextThreadIds(context_id, thread_id);
+        accelManager->acceleratorFinished(handle);
     }
 
-    /* Adds the specified accelerator to the event queue with a given number of
-     * delay cycles (to emulate software overhead during invocation).
-     */
-    void scheduleAccelerator(int id, int delay)
+    /* Marks an accelerator as finished by erasing it from the registered list. */
+    void deregisterAccelerator(int id)
     {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to schedule accelerator: No accelerator with id %#x.", id);
-        Gem5Datapath *datapath = accelerators[id]->datapath;
-        datapath->initializeDatapath(delay);
-        DPRINTF(Aladdin, "Scheduling accelerator %d\n", id);
+        accelManager->deregisterAccelerator(id);
     }
 
     /* Activates an accelerator with the provided parameters. */
     void activateAccelerator(
             unsigned accel_id, Addr finish_flag, int context_id, int thread_id) {
-        DPRINTF(Aladdin, "Activating accelerator id %d\n", accel_id);
-        setAcceleratorFinishFlag(accel_id, finish_flag);
-        setAcceleratorIds(accel_id, context_id, thread_id);
-        scheduleAccelerator(accel_id, 1);
+        accelManager->activate(accel_id, finish_flag, context_id, thread_id);
     }
 
     /* Add an address tranlation into the datapath TLB for the specified array. */
-    void insertAddressTranslationMapping(int id, Addr sim_vaddr, Addr sim_paddr) {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to add address mapping: No accelerator with id %#x.",
-                  id);
-        Gem5Datapath* datapath = accelerators[id]->datapath;
-        datapath->insertTLBEntry(sim_vaddr, sim_paddr);
-    }
+    void insertAddressTranslationMapping(
+            int id, Addr sim_vaddr, Addr sim_paddr,
+            int context_id = AcceleratorManager::AnyContext);
+
+    /* Add the translation of a virtually and physically contiguous region
+     * into the datapath TLB. Datapaths that support range entries receive
+     * a single entry; others get one entry per page.
+     */
+    void insertAddressRangeMapping(
+            int id, Addr sim_vaddr, Addr sim_paddr, Addr size,
+            int context_id = AcceleratorManager::AnyContext);
 
     /* Add an mapping between array names to the simulated virtual addresses. */
-    void insertArrayLabelMapping(int id, std::string array_label, Addr sim_vaddr) {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to add array label mapping: No accelerator with id %#x.",
-                  id);
-        Gem5Datapath* datapath = accelerators[id]->datapath;
-        datapath->insertArrayLabelToVirtual(array_label, sim_vaddr);
-    }
+    void insertArrayLabelMapping(
+            int id, std::string array_label, Addr sim_vaddr,
+            int context_id = AcceleratorManager::AnyContext);
 
     /* Get the base trace address of of the array for the specified accelerator. */
-    Addr getArrayBaseAddress(int id, const char* array_name) {
-        if (accelerators.find(id) == accelerators.end())
-            fatal("Unable to get array base address: No accelerator with id %#x.",
-                  id);
-        Gem5Datapath* datapath = accelerators[id]->datapath;
-        return datapath->getBaseAddress(std::string(array_name));
-    }
+    Addr getArrayBaseAddress(
+            int id, const char* array_name,
+            int context_id = AcceleratorManager::AnyContext);
 
     /** Return number of running (non-halted) thread contexts in
      * system.  These threads could be Active or Suspended. */
     int numRunningContexts();
 
+    /**
+     * Get the accelerator task data registry of a thread context. Every
+     * context has its own, so several cores can produce task data for
+     * their accelerators at the same time.
+     */
+    AccTaskDataRegistry &accTaskData(int context_id);
+
+    /**
+     * Get the task data registry of a context if it has buffers
+     * registered, or nullptr if its data is not being forwarded. This is
+     * the check caches make on every access.
+     */
+    AccTaskDataRegistry *
+    forwardedAccTaskData(int context_id)
+    {
+        if (context_id < 0 || context_id >= accTaskDataRegs.size())
+            return nullptr;
+        AccTaskDataRegistry *registry = accTaskDataRegs[context_id];
+        return registry->empty() ? nullptr : registry;
+    }
+
     Addr pagePtr;
 
+    /** Physical pages given back by freePhysPages(). */
+    std::vector<Addr> freedPages;
+
     uint64_t init_param;
 
     /** Port to physical memory used for writing object files into ram at
@@ -643,6 +620,23 @@ class System : public MemObject
     /// @return Starting address of first page
     Addr allocPhysPages(int npages);
 
+    /**
+     * Allocate npages contiguous unused physical pages starting at the
+     * given offset within a naturally aligned block of align bytes, so
+     * that huge pages can map them. The pages skipped to reach that
+     * offset are freed rather than lost.
+     * @return Starting address of first page
+     */
+    Addr allocAlignedPhysPages(int npages, Addr align, Addr offset);
+
+    /// Give back npages contiguous physical pages that are no longer
+    /// mapped, to be handed out again by allocFreedPhysPage()
+    void freePhysPages(Addr paddr, int npages);
+
+    /// Take a single page given back by freePhysPages(), cleared to zero
+    /// @return False if there are no freed pages
+    bool allocFreedPhysPage(Addr &paddr);
+
     int registerThreadContext(ThreadContext *tc, int assigned=-1);
     void replaceThreadContext(ThreadContext *tc, int context_id);
 
@@ -657,6 +651,8 @@ class System : public MemObject
     EventQueue instEventQueue;
     std::map<std::pair<uint32_t,uint32_t>, Tick>  lastWorkItemStarted;
     std::map<uint32_t, Stats::Histogram*> workItemStats;
+    /** Accelerator task data registries indexed by context id */
+    std::vector<AccTaskDataRegistry *> accTaskDataRegs;
 
     ////////////////////////////////////////////
     //
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Hold-model microbenchmark for the event queue: a fixed population of
+ * events that reschedule themselves at random delays, run once with
+ * the sorted list of bins and once with the calendar queue. Both runs
+ * draw the same random numbers, so they must also service the events
+ * in exactly the same order.
+ */
+
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/random.hh"
+#include "base/time.hh"
+#include "sim/eventq_impl.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+struct HoldModel;
+
+class HoldEvent : public Event
+{
+  private:
+    HoldModel &model;
+    int id;
+
+  public:
+    HoldEvent(HoldModel &model, int id, Priority p)
+        : Event(p), model(model), id(id)
+    {}
+
+    void process();
+};
+
+struct HoldModel
+{
+    EventQueue queue;
+    Random rng;
+    vector<HoldEvent *> events;
+    vector<int> order;
+    bool record;
+
+    HoldModel(int pending, uint32_t seed)
+        : queue("hold"), record(false)
+    {
+        static const Event::Priority prios[] = {
+            Event::Default_Pri, Event::DVFS_Update_Pri,
+            Event::CPU_Tick_Pri, Event::Delayed_Writeback_Pri,
+        };
+
+        rng.init(seed);
+        for (int i = 0; i < pending; ++i) {
+            int p = rng.random<int>(0, 3);
+            events.push_back(new HoldEvent(*this, i, prios[p]));
+        }
+        for (int i = 0; i < pending; ++i)
+            hold(events[i]);
+    }
+
+    ~HoldModel()
+    {
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (events[i]->scheduled())
+                queue.deschedule(events[i]);
+            delete events[i];
+        }
+    }
+
+    /**
+     * Mostly clock-aligned delays so that bins hold several events,
+     * with an occasional long one to spread the pending times out.
+     */
+    Tick
+    delay()
+    {
+        if (rng.random<int>(0, 15) == 0)
+            return rng.random<Tick>(1, 1000000);
+        return 500 * rng.random<Tick>(0, 40);
+    }
+
+    void
+    hold(HoldEvent *event)
+    {
+        queue.schedule(event, queue.getCurTick() + delay());
+
+        // Move some other event around now and then so that removal
+        // from the middle of the queue gets exercised as well.
+        if (rng.random<int>(0, 7) == 0) {
+            HoldEvent *other = events[rng.random<int>(0, events.size() - 1)];
+            if (other != event && other->scheduled())
+                queue.reschedule(other, queue.getCurTick() + delay(), true);
+        }
+    }
+
+    double
+    run(bool calendar, int count)
+    {
+        queue.useCalendar(calendar);
+
+        Time start;
+        start.setTimer();
+        for (int i = 0; i < count; ++i)
+            queue.serviceOne();
+        Time end;
+        end.setTimer();
+
+        return end - start;
+    }
+};
+
+void
+HoldEvent::process()
+{
+    if (model.record)
+        model.order.push_back(id);
+    model.hold(this);
+}
+
+int
+main()
+{
+    const int pending[] = { 16, 256, 4096, 16384 };
+    const int count = 200000;
+
+    for (size_t i = 0; i < sizeof(pending) / sizeof(pending[0]); ++i) {
+        HoldModel list(pending[i], i + 1);
+        HoldModel calendar(pending[i], i + 1);
+
+        list.record = calendar.record = true;
+        list.run(false, count / 10);
+        calendar.run(true, count / 10);
+
+        UnitTest::setCase("service order");
+        EXPECT_TRUE(list.order == calendar.order);
+
+        list.record = calendar.record = false;
+        double list_time = list.run(false, count);
+        double calendar_time = calendar.run(true, count);
+
+        cprintf("%6d pending: list %.3fs, calendar %.3fs (%.2fx)\n",
+                pending[i], list_time, calendar_time,
+                list_time / calendar_time);
+    }
+
+    return UnitTest::printResults();
+}
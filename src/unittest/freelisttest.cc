@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <cassert>
+#include <iostream>
+
+#include "base/free_list.hh"
+
+using namespace std;
+
+struct Counted
+{
+    static int live;
+    int value;
+
+    Counted(int v) : value(v) { live++; }
+    ~Counted() { live--; }
+};
+
+int Counted::live = 0;
+
+int
+main()
+{
+    FreeList<Counted> list(2);
+
+    Counted *a = list.allocate(1);
+    Counted *b = list.allocate(2);
+    Counted *c = list.allocate(3);
+    assert(Counted::live == 3);
+    assert(list.heapAllocations() == 3);
+
+    list.release(a);
+    list.release(b);
+    list.release(c);
+    assert(Counted::live == 0);
+    // only two blocks are kept, the third goes back to the heap
+    assert(list.size() == 2);
+
+    // released storage is reused before going to the heap again
+    Counted *d = list.allocate(4);
+    assert(d == b);
+    assert(d->value == 4);
+    Counted *e = list.allocate(5);
+    assert(e == a);
+    Counted *f = list.allocate(6);
+    assert(list.heapAllocations() == 4);
+    assert(list.size() == 0);
+
+    // objects from the list can be deleted by their owner, and objects
+    // from the heap can be released to the list
+    delete f;
+    list.release(new Counted(7));
+    assert(list.size() == 1);
+    list.release(d);
+    list.release(e);
+    assert(Counted::live == 0);
+
+    cout << "free list heap allocations: " << list.heapAllocations() << endl;
+
+    return 0;
+}
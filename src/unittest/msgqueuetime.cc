@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2016 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Microbenchmark for the ordering of Ruby message buffers: the same
+ * stream of messages goes through the binary heap MessageBuffer used
+ * to keep and through MessageQueue. Messages are mostly enqueued in
+ * order, a cycle or a few ahead, and now and then one is recycled to a
+ * later cycle. The messages of the MessageQueue run are created with
+ * allocateMessage(), those of the heap run with make_shared(). Both
+ * runs draw the same random numbers, so they must also dequeue the
+ * messages in exactly the same order.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/random.hh"
+#include "base/time.hh"
+#include "mem/ruby/network/MessageQueue.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+class TestMsg : public Message
+{
+  public:
+    TestMsg(Tick time, int id) : Message(time), id(id) {}
+
+    MsgPtr clone() const { return allocateMessage<TestMsg>(*this); }
+    void print(ostream &out) const { out << "[TestMsg " << id << "]"; }
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+
+    int id;
+};
+
+//! The binary heap of MessageBufferNodes, as MessageBuffer had it.
+class HeapQueue
+{
+  private:
+    vector<MessageBufferNode> heap;
+
+  public:
+    bool empty() const { return heap.empty(); }
+    const MessageBufferNode &front() const { return heap.front(); }
+
+    void
+    push(Tick time, uint64_t counter, const MsgPtr &msg)
+    {
+        heap.push_back(MessageBufferNode(time, counter, msg));
+        push_heap(heap.begin(), heap.end(), greater<MessageBufferNode>());
+    }
+
+    void
+    pop()
+    {
+        pop_heap(heap.begin(), heap.end(), greater<MessageBufferNode>());
+        heap.pop_back();
+    }
+
+    void
+    recycle(Tick time)
+    {
+        MessageBufferNode node = heap.front();
+        pop();
+        heap.push_back(node);
+        heap.back().m_time = time;
+        push_heap(heap.begin(), heap.end(), greater<MessageBufferNode>());
+    }
+};
+
+//! MessageQueue with the same interface as HeapQueue.
+class ListQueue
+{
+  private:
+    MessageQueue queue;
+
+  public:
+    bool empty() const { return queue.empty(); }
+    const MessageBufferNode &front() const { return queue.front(); }
+
+    void
+    push(Tick time, uint64_t counter, const MsgPtr &msg)
+    {
+        queue.push(time, counter, msg);
+    }
+
+    void pop() { queue.pop(); }
+
+    void
+    recycle(Tick time)
+    {
+        MessageBufferNode *node = queue.popNode();
+        node->m_time = time;
+        queue.pushNode(node);
+    }
+};
+
+/**
+ * A buffer with a number of senders, each enqueueing a message every
+ * few cycles, drained by a receiver every cycle.
+ */
+template <class Queue>
+double
+run(uint32_t seed, int senders, int cycles, bool pooled, vector<int> *order)
+{
+    const Tick period = 500;
+    Queue queue;
+    Random rng;
+    rng.init(seed);
+    uint64_t counter = 0;
+    int next_id = 0;
+
+    Time start;
+    start.setTimer();
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        Tick now = cycle * period;
+
+        for (int s = 0; s < senders; ++s) {
+            if (rng.random<int>(0, 3) != 0)
+                continue;
+            // Mostly the next cycle, sometimes a longer latency.
+            Tick latency = period;
+            if (rng.random<int>(0, 7) == 0)
+                latency *= rng.random<int>(2, 20);
+            MsgPtr msg;
+            if (pooled)
+                msg = allocateMessage<TestMsg>(now, next_id++);
+            else
+                msg = make_shared<TestMsg>(now, next_id++);
+            queue.push(now + latency, ++counter, msg);
+        }
+
+        while (!queue.empty() && queue.front().m_time <= now) {
+            if (rng.random<int>(0, 15) == 0) {
+                queue.recycle(now + period * rng.random<int>(1, 10));
+                continue;
+            }
+            if (order) {
+                const TestMsg *msg = static_cast<const TestMsg *>(
+                    queue.front().m_msgptr.get());
+                order->push_back(msg->id);
+            }
+            queue.pop();
+        }
+    }
+    Time end;
+    end.setTimer();
+
+    return end - start;
+}
+
+int
+main()
+{
+    const int senders[] = { 1, 8, 64, 256 };
+    const int cycles = 100000;
+
+    for (size_t i = 0; i < sizeof(senders) / sizeof(senders[0]); ++i) {
+        vector<int> heap_order, list_order;
+        run<HeapQueue>(i + 1, senders[i], cycles / 20, false, &heap_order);
+        run<ListQueue>(i + 1, senders[i], cycles / 20, true, &list_order);
+
+        UnitTest::setCase("dequeue order");
+        EXPECT_TRUE(heap_order == list_order);
+
+        double heap_time =
+            run<HeapQueue>(i + 1, senders[i], cycles, false, NULL);
+        double list_time =
+            run<ListQueue>(i + 1, senders[i], cycles, true, NULL);
+
+        cprintf("%4d senders: heap %.3fs, list %.3fs (%.2fx)\n",
+                senders[i], heap_time, list_time, heap_time / list_time);
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,218 @@
+# Copyright (c) 2016 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+"""Reader for the binary statistics files written by gem5's
+--stats-binary-file option (Stats::Binary in src/base/stats/binary.hh).
+
+A file defines each stat's columns in a schema record the first time
+the stat is dumped, and holds one record per stats dump with the values
+of the stats that dump picked. Loading keeps each dump as a flat array
+of doubles, so even files with thousands of dumps load quickly; column
+lookups are resolved through a schema shared by consecutive dumps that
+hold the same stats.
+
+Usage as a script:
+
+    binary.py FILE                 list the dumps in FILE
+    binary.py FILE STAT [STAT...]  print the value of STATs in every dump
+"""
+
+import array
+import struct
+import sys
+
+MAGIC = b'gem5stat'
+VERSION = 2
+
+class Dump(object):
+    """The values of a single stats dump."""
+    def __init__(self, index, tick, desc, schema, values):
+        self.index = index
+        self.tick = tick
+        self.desc = desc
+        self.schema = schema
+        self.values = values
+
+    def __getitem__(self, name):
+        return self.values[self.schema.index[name]]
+
+    def get(self, name, default=None):
+        col = self.schema.index.get(name)
+        if col is None:
+            return default
+        return self.values[col]
+
+    def __contains__(self, name):
+        return name in self.schema.index
+
+    def items(self):
+        return zip(self.schema.names, self.values)
+
+class Schema(object):
+    """The column names and descriptions shared by consecutive dumps."""
+    def __init__(self, names, descs):
+        self.names = names
+        self.descs = descs
+        self.index = dict((name, i) for i, name in enumerate(names))
+
+class StatDef(object):
+    """The columns of one stat, as given by its latest schema record."""
+    def __init__(self, names, descs):
+        self.names = names
+        self.descs = descs
+
+class BinaryStats(object):
+    def __init__(self, filename):
+        self.filename = filename
+        self.schemas = []
+        self.dumps = []
+
+        with open(filename, 'rb') as f:
+            self._parse(f.read())
+
+    def _parse(self, data):
+        if data[:len(MAGIC)] != MAGIC:
+            raise ValueError("%s is not a binary stats file" % self.filename)
+        pos = len(MAGIC)
+        version, = struct.unpack_from('<I', data, pos)
+        pos += 4
+        if version != VERSION:
+            raise ValueError("%s has unsupported version %d" %
+                             (self.filename, version))
+
+        def read_string(pos):
+            length, = struct.unpack_from('<H', data, pos)
+            pos += 2
+            return data[pos:pos + length].decode('utf-8', 'replace'), \
+                pos + length
+
+        stats = {}
+        layout = None
+        schema = None
+        while pos < len(data):
+            tag = data[pos:pos + 1]
+            pos += 1
+            if tag == b'S':
+                stat, ncols = struct.unpack_from('<II', data, pos)
+                pos += 8
+                names = []
+                descs = []
+                for i in range(ncols):
+                    name, pos = read_string(pos)
+                    desc, pos = read_string(pos)
+                    names.append(name)
+                    descs.append(desc)
+                stats[stat] = StatDef(names, descs)
+            elif tag == b'D':
+                tick, = struct.unpack_from('<Q', data, pos)
+                pos += 8
+                desc, pos = read_string(pos)
+                nstats, = struct.unpack_from('<I', data, pos)
+                pos += 4
+                defs = []
+                chunks = []
+                for i in range(nstats):
+                    if pos + 4 > len(data):
+                        break
+                    stat, = struct.unpack_from('<I', data, pos)
+                    pos += 4
+                    if stat not in stats:
+                        raise ValueError("%s: dump %d has undefined stat %d" %
+                                         (self.filename, len(self.dumps),
+                                          stat))
+                    end = pos + 8 * len(stats[stat].names)
+                    if end > len(data):
+                        break
+                    defs.append(stats[stat])
+                    chunks.append(data[pos:end])
+                    pos = end
+                if len(defs) != nstats:
+                    # A run that was killed mid-dump leaves a partial
+                    # record behind; keep everything before it.
+                    break
+                # Consecutive dumps usually hold the same stats, so they
+                # share one Schema instead of rebuilding the name index.
+                if layout is None or len(layout) != len(defs) or \
+                   any(a is not b for a, b in zip(layout, defs)):
+                    layout = defs
+                    schema = Schema(
+                        [ n for d in defs for n in d.names ],
+                        [ n for d in defs for n in d.descs ])
+                    self.schemas.append(schema)
+                values = array.array('d')
+                raw = b''.join(chunks)
+                if hasattr(values, 'frombytes'):
+                    values.frombytes(raw)
+                else:
+                    values.fromstring(raw)
+                if sys.byteorder == 'big':
+                    values.byteswap()
+                self.dumps.append(Dump(len(self.dumps), tick, desc, schema,
+                                       values))
+            else:
+                raise ValueError("%s: bad record tag at offset %d" %
+                                 (self.filename, pos - 1))
+
+    def __len__(self):
+        return len(self.dumps)
+
+    def __iter__(self):
+        return iter(self.dumps)
+
+    def __getitem__(self, index):
+        return self.dumps[index]
+
+    def names(self):
+        """All column names that appear in any dump, in schema order."""
+        seen = set()
+        names = []
+        for schema in self.schemas:
+            for name in schema.names:
+                if name not in seen:
+                    seen.add(name)
+                    names.append(name)
+        return names
+
+    def column(self, name, default=None):
+        """The values of one stat across all dumps."""
+        return [ dump.get(name, default) for dump in self.dumps ]
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+
+    stats = BinaryStats(sys.argv[1])
+    if len(sys.argv) == 2:
+        for dump in stats:
+            print("%d: tick %d, %d stats%s" %
+                  (dump.index, dump.tick, len(dump.values),
+                   dump.desc and " (%s)" % dump.desc or ""))
+    else:
+        for dump in stats:
+            for name in sys.argv[2:]:
+                print("%d %s %s" % (dump.index, name, dump.get(name)))